@@ -0,0 +1,632 @@
+/*********************************P1BENCH.C******************************
+ *
+ *	Host microbenchmarks for the phase 1 modules.
+ *
+ *	Times every function of pcb.h, asl.h and proc.h, but the
+ *	KAYA_SMP variants, at several scales (queue lengths, active
+ *	semaphores, tree fan-outs and depths, pool sizes) and prints
+ *	one record per function and
+ *	scale: the best ns/op over REPS repetitions and, in a KAYA_STATS
+ *	build, the ASL descriptors visited per op. Input is generated from
+ *	a fixed seed, so runs of the same build are comparable.
+ *
+ *	Usage: p1bench [-f csv|json] [-r reps]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "const.h"
+#include "types.h"
+
+#include "pcb.h"
+#include "asl.h"
+#include "proc.h"
+#include "wheel.h"
+#include "stats.h"
+
+#define TARGETOPS 131072	/* ops timed per repetition, at least */
+#define BATCH 64		/* semaphores activated per round by the ASL benchmarks */
+
+HIDDEN const int scales[] = { 16, 128, 1024, 4096 };
+#define NSCALES ((int) (sizeof(scales) / sizeof(scales[0])))
+
+HIDDEN int reps = 5;
+HIDDEN int json = FALSE;
+HIDDEN int records = 0;
+HIDDEN double clockCost;	/* ns taken by an empty timed region */
+
+HIDDEN pcb_t *pcbs[MAXPROC];
+HIDDEN int perm[MAXPROC];
+HIDDEN int sems[2 * MAXPROC];
+HIDDEN wheel_t wheel;
+HIDDEN unsigned int seed;
+
+
+/**
+* @brief Accumulated time and ASL visits of the timed regions of a repetition.
+*/
+typedef struct probe_t {
+	double pr_ns;			/* time spent in timed regions */
+	unsigned long pr_visits;	/* ASL descriptors visited in them */
+	long pr_ops;			/* operations timed */
+	double pr_t0;			/* start of the open region */
+	unsigned long pr_v0;
+} probe_t;
+
+
+HIDDEN double nowNs(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+HIDDEN unsigned long aslVisits(void) {
+#ifdef KAYA_STATS
+	return kstats.st_aslVisits;
+#else
+	return 0;
+#endif
+}
+
+
+/* Open a timed region */
+HIDDEN void startProbe(probe_t *pr) {
+	pr->pr_v0 = aslVisits();
+	pr->pr_t0 = nowNs();
+}
+
+
+/* Close a timed region that ran ops operations */
+HIDDEN void stopProbe(probe_t *pr, long ops) {
+	pr->pr_ns += nowNs() - pr->pr_t0 - clockCost;
+	pr->pr_visits += aslVisits() - pr->pr_v0;
+	pr->pr_ops += ops;
+}
+
+
+/* Rounds of ops operations needed to time about TARGETOPS */
+HIDDEN int roundsFor(int ops) {
+	return ops >= TARGETOPS ? 1 : TARGETOPS / ops;
+}
+
+
+/* Deterministic pseudo-random numbers */
+HIDDEN unsigned int nextRand(void) {
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+
+/* Fill perm[0..n) with a random permutation of 0..n-1 */
+HIDDEN void shuffle(int n) {
+	int i, j, t;
+
+	for (i = 0; i < n; i++)
+		perm[i] = i;
+	for (i = n - 1; i > 0; i--) {
+		j = nextRand() % (i + 1);
+		t = perm[i];
+		perm[i] = perm[j];
+		perm[j] = t;
+	}
+}
+
+
+HIDDEN const char *config(void) {
+#if defined(ASL_SORTED) && defined(PCB_COMPACT)
+	return "sorted+compact";
+#elif defined(ASL_SORTED)
+	return "sorted";
+#elif defined(PCB_COMPACT)
+	return "hash+compact";
+#else
+	return "hash";
+#endif
+}
+
+
+/* Print the record of the best of the probes pr[0..reps) */
+HIDDEN void report(const char *group, const char *func, int n, probe_t *pr) {
+	int i, best = 0;
+	double ns, visits;
+
+	for (i = 1; i < reps; i++)
+		if (pr[i].pr_ns * pr[best].pr_ops < pr[best].pr_ns * pr[i].pr_ops)
+			best = i;
+	ns = pr[best].pr_ns / pr[best].pr_ops;
+	visits = (double) pr[best].pr_visits / pr[best].pr_ops;
+	if (ns < 0)
+		ns = 0;
+	if (json)
+		printf("%s\n  {\"group\": \"%s\", \"function\": \"%s\", \"config\": \"%s\", "
+			"\"maxproc\": %d, \"n\": %d, \"ops\": %ld, \"ns_per_op\": %.2f, "
+			"\"visits_per_op\": %.2f}",
+			records ? "," : "", group, func, config(), MAXPROC, n,
+			pr[best].pr_ops, ns, visits);
+	else
+		printf("%s,%s,%s,%d,%d,%ld,%.2f,%.2f\n", group, func, config(), MAXPROC,
+			n, pr[best].pr_ops, ns, visits);
+	records++;
+}
+
+
+/* Reset the modules and the input generator */
+HIDDEN void resetAll(void) {
+	initPcbs();
+	initASL();
+	initWheel(&wheel);
+	seed = 1;
+}
+
+
+/* initPcbs(), initASL(), allocPcb(), freePcb(), growPcbs(), growSemds()
+ *	and the counters, on pools of n entries */
+HIDDEN void benchPool(int n) {
+	enum { INITPCBS, INITASL, INITSEMD, ALLOC, FREE, FREECOUNT, USEDCOUNT, GROWPCBS, GROWSEMDS, NP };
+	static probe_t pr[NP][16];
+	int r, k, i, rounds = roundsFor(n);
+	volatile int sink;
+	void *mem;
+
+	memset(pr, 0, sizeof(pr));
+	resetAll();
+	for (r = 0; r < reps; r++) {
+		for (k = 0; k < rounds; k++) {
+			startProbe(&pr[INITPCBS][r]);
+			initPcbs();
+			stopProbe(&pr[INITPCBS][r], 1);
+			startProbe(&pr[INITASL][r]);
+			initASL();
+			stopProbe(&pr[INITASL][r], 1);
+			startProbe(&pr[INITSEMD][r]);
+			initSemd();
+			stopProbe(&pr[INITSEMD][r], 1);
+
+			startProbe(&pr[ALLOC][r]);
+			for (i = 0; i < n; i++)
+				pcbs[i] = allocPcb();
+			stopProbe(&pr[ALLOC][r], n);
+			startProbe(&pr[FREECOUNT][r]);
+			for (i = 0; i < n; i++)
+				sink = pcbFreeCount();
+			stopProbe(&pr[FREECOUNT][r], n);
+			startProbe(&pr[USEDCOUNT][r]);
+			for (i = 0; i < n; i++)
+				sink = pcbUsedCount() + semdFreeCount() + semdUsedCount();
+			stopProbe(&pr[USEDCOUNT][r], n);
+			startProbe(&pr[FREE][r]);
+			for (i = 0; i < n; i++)
+				freePcb(pcbs[i]);
+			stopProbe(&pr[FREE][r], n);
+		}
+		/* growing takes fresh memory: one round only */
+		mem = malloc(n * sizeof(pcb_t));
+		startProbe(&pr[GROWPCBS][r]);
+		growPcbs(mem, n * sizeof(pcb_t));
+		stopProbe(&pr[GROWPCBS][r], n);
+		initPcbs();
+		free(mem);
+		mem = malloc(n * 64);
+		startProbe(&pr[GROWSEMDS][r]);
+		growSemds(mem, n * 64);
+		stopProbe(&pr[GROWSEMDS][r], n);
+		initASL();
+		free(mem);
+	}
+	(void) sink;
+	report("pool", "initPcbs", MAXPROC, pr[INITPCBS]);
+	report("pool", "initASL", MAXPROC, pr[INITASL]);
+	report("pool", "initSemd", MAXPROC, pr[INITSEMD]);
+	report("pool", "allocPcb", n, pr[ALLOC]);
+	report("pool", "freePcb", n, pr[FREE]);
+	report("pool", "pcbFreeCount", n, pr[FREECOUNT]);
+	report("pool", "pcbUsedCount+semdFreeCount+semdUsedCount", n, pr[USEDCOUNT]);
+	report("pool", "growPcbs/entry", n, pr[GROWPCBS]);
+	report("pool", "growSemds/entry", n, pr[GROWSEMDS]);
+}
+
+
+/* The ProcQ functions on a queue of n ProcBlks */
+HIDDEN void benchQueue(int n) {
+	enum { MKEMPTY, INSERT, HEAD, EMPTY, OUT, REMOVE, CONCAT, SPLIT, NP };
+	static probe_t pr[NP][16];
+	int r, k, i, rounds = roundsFor(n);
+	pcb_t *tp, *sp;
+	volatile int sink;
+
+	memset(pr, 0, sizeof(pr));
+	resetAll();
+	for (i = 0; i < n; i++)
+		pcbs[i] = allocPcb();
+	shuffle(n);
+	for (r = 0; r < reps; r++)
+		for (k = 0; k < rounds; k++) {
+			startProbe(&pr[MKEMPTY][r]);
+			for (i = 0; i < n; i++)
+				tp = mkEmptyProcQ();
+			stopProbe(&pr[MKEMPTY][r], n);
+			startProbe(&pr[INSERT][r]);
+			for (i = 0; i < n; i++)
+				insertProcQ(&tp, pcbs[i]);
+			stopProbe(&pr[INSERT][r], n);
+			startProbe(&pr[HEAD][r]);
+			for (i = 0; i < n; i++)
+				sink = headProcQ(tp) != NULL;
+			stopProbe(&pr[HEAD][r], n);
+			startProbe(&pr[EMPTY][r]);
+			for (i = 0; i < n; i++)
+				sink = emptyProcQ(tp);
+			stopProbe(&pr[EMPTY][r], n);
+			startProbe(&pr[OUT][r]);	/* from anywhere in the queue */
+			for (i = 0; i < n; i++)
+				outProcQ(&tp, pcbs[perm[i]]);
+			stopProbe(&pr[OUT][r], n);
+
+			/* two halves, joined, then moved back and forth whole */
+			sp = mkEmptyProcQ();
+			for (i = 0; i < n; i++)
+				insertProcQ(i < n / 2 ? &tp : &sp, pcbs[i]);
+			startProbe(&pr[CONCAT][r]);
+			for (i = 0; i < n; i++)
+				if (i & 1)
+					concatProcQ(&tp, &sp);
+				else
+					concatProcQ(&sp, &tp);
+			stopProbe(&pr[CONCAT][r], n);
+			startProbe(&pr[SPLIT][r]);	/* the whole queue there and back */
+			splitProcQ(&sp, &tp, n);
+			splitProcQ(&tp, &sp, n);
+			stopProbe(&pr[SPLIT][r], 2 * n);
+			startProbe(&pr[REMOVE][r]);
+			for (i = 0; i < n; i++)
+				removeProcQ(&tp);
+			stopProbe(&pr[REMOVE][r], n);
+		}
+	(void) sink;
+	report("procq", "mkEmptyProcQ", n, pr[MKEMPTY]);
+	report("procq", "insertProcQ", n, pr[INSERT]);
+	report("procq", "headProcQ", n, pr[HEAD]);
+	report("procq", "emptyProcQ", n, pr[EMPTY]);
+	report("procq", "outProcQ", n, pr[OUT]);
+	report("procq", "concatProcQ", n, pr[CONCAT]);
+	report("procq", "splitProcQ/entry", n, pr[SPLIT]);
+	report("procq", "removeProcQ", n, pr[REMOVE]);
+}
+
+
+/* The tree functions on a parent with n children */
+HIDDEN void benchFanout(int n) {
+	enum { INSERT, INSERTHEAD, EMPTY, OUT, REMOVE, NP };
+	static probe_t pr[NP][16];
+	int r, k, i, rounds = roundsFor(n);
+	pcb_t *prnt;
+	volatile int sink;
+
+	if (n + 1 > MAXPROC)
+		return;
+	memset(pr, 0, sizeof(pr));
+	resetAll();
+	prnt = allocPcb();
+	for (i = 0; i < n; i++)
+		pcbs[i] = allocPcb();
+	shuffle(n);
+	for (r = 0; r < reps; r++)
+		for (k = 0; k < rounds; k++) {
+			startProbe(&pr[INSERT][r]);
+			for (i = 0; i < n; i++)
+				insertChild(prnt, pcbs[i]);
+			stopProbe(&pr[INSERT][r], n);
+			startProbe(&pr[EMPTY][r]);
+			for (i = 0; i < n; i++)
+				sink = emptyChild(prnt);
+			stopProbe(&pr[EMPTY][r], n);
+			startProbe(&pr[OUT][r]);	/* from anywhere among the siblings */
+			for (i = 0; i < n; i++)
+				outChild(pcbs[perm[i]]);
+			stopProbe(&pr[OUT][r], n);
+			startProbe(&pr[INSERTHEAD][r]);
+			for (i = 0; i < n; i++)
+				insertChildHead(prnt, pcbs[i]);
+			stopProbe(&pr[INSERTHEAD][r], n);
+			startProbe(&pr[REMOVE][r]);
+			for (i = 0; i < n; i++)
+				removeChild(prnt);
+			stopProbe(&pr[REMOVE][r], n);
+		}
+	(void) sink;
+	report("tree", "insertChild", n, pr[INSERT]);
+	report("tree", "insertChildHead", n, pr[INSERTHEAD]);
+	report("tree", "emptyChild", n, pr[EMPTY]);
+	report("tree", "outChild", n, pr[OUT]);
+	report("tree", "removeChild", n, pr[REMOVE]);
+}
+
+
+/* terminateSubtree() and the CPU time accounting on a chain of depth n,
+ *	half of it ready */
+HIDDEN void benchDepth(int n) {
+	enum { TERMINATE, CHARGE, CPUTIME, SUBTIME, REAP, NP };
+	static probe_t pr[NP][16];
+	int r, k, i, rounds = roundsFor(n);
+	pcb_t *readyq;
+	volatile cputime_t sink;
+
+	if (n > MAXPROC)
+		return;
+	memset(pr, 0, sizeof(pr));
+	resetAll();
+	for (r = 0; r < reps; r++)
+		for (k = 0; k < rounds; k++) {
+			readyq = mkEmptyProcQ();
+			for (i = 0; i < n; i++) {
+				pcbs[i] = allocPcb();
+				if (i > 0)
+					insertChild(pcbs[i - 1], pcbs[i]);
+				if (i & 1)
+					insertProcQ(&readyq, pcbs[i]);
+			}
+			startProbe(&pr[CHARGE][r]);	/* at the deepest process */
+			for (i = 0; i < n; i++)
+				chargeTime(pcbs[n - 1], 1);
+			stopProbe(&pr[CHARGE][r], n);
+			startProbe(&pr[CPUTIME][r]);
+			for (i = 0; i < n; i++)
+				sink = cpuTime(pcbs[i]);
+			stopProbe(&pr[CPUTIME][r], n);
+			startProbe(&pr[SUBTIME][r]);
+			for (i = 0; i < n; i++)
+				sink = subtreeTime(pcbs[i]);
+			stopProbe(&pr[SUBTIME][r], n);
+			if (k & 1) {	/* reap the chain from the bottom ... */
+				for (i = n - 1; i > 0; i--)
+					if (i & 1)
+						outProcQ(&readyq, pcbs[i]);
+				startProbe(&pr[REAP][r]);
+				for (i = n - 1; i > 0; i--)
+					reapChild(pcbs[i]);
+				stopProbe(&pr[REAP][r], n - 1);
+				for (i = 0; i < n; i++)
+					freePcb(pcbs[i]);
+			}
+			else {		/* ... or terminate it from the top */
+				startProbe(&pr[TERMINATE][r]);
+				terminateSubtree(pcbs[0]);
+				stopProbe(&pr[TERMINATE][r], n);
+			}
+		}
+	(void) sink;
+	report("tree", "terminateSubtree/node", n, pr[TERMINATE]);
+	report("tree", "chargeTime", n, pr[CHARGE]);
+	report("tree", "cpuTime", n, pr[CPUTIME]);
+	report("tree", "subtreeTime", n, pr[SUBTIME]);
+	report("tree", "reapChild", n, pr[REAP]);
+}
+
+
+/* The ASL functions with n semaphores already active, one waiter each */
+HIDDEN void benchAsl(int n) {
+	enum { INSERT, INSERTQ, HEAD, HEADMISS, OUT, REMOVE, REMOVEALL, RANGE, TIMED,
+		DINSERT, DREMOVE, PFAST, VFAST, PBLOCK, VWAKE, NP };
+	static probe_t pr[NP][16];
+	int r, k, i, rounds = roundsFor(BATCH);
+	int *bsem = &sems[MAXPROC];	/* the semaphores of the batch */
+	static int devsem[BATCH];	/* direct-indexed, like device semaphores */
+	pcb_t *tp;
+
+	if (n + 2 * BATCH > MAXPROC)
+		return;
+	memset(pr, 0, sizeof(pr));
+	resetAll();
+	/* the background: n semaphores scattered over sems[0..MAXPROC) */
+	shuffle(MAXPROC);
+	for (i = 0; i < n; i++)
+		insertBlocked(&sems[perm[i]], allocPcb());
+	for (i = 0; i < 2 * BATCH; i++)
+		pcbs[i] = allocPcb();
+	registerSemds(devsem, BATCH);
+	for (r = 0; r < reps; r++)
+		for (k = 0; k < rounds; k++) {
+			/* activate BATCH semaphores, then queue a second waiter on each */
+			startProbe(&pr[INSERT][r]);
+			for (i = 0; i < BATCH; i++)
+				insertBlocked(&bsem[i], pcbs[i]);
+			stopProbe(&pr[INSERT][r], BATCH);
+			startProbe(&pr[INSERTQ][r]);
+			for (i = 0; i < BATCH; i++)
+				insertBlocked(&bsem[i], pcbs[BATCH + i]);
+			stopProbe(&pr[INSERTQ][r], BATCH);
+			startProbe(&pr[HEAD][r]);
+			for (i = 0; i < BATCH; i++)
+				headBlocked(&bsem[i]);
+			stopProbe(&pr[HEAD][r], BATCH);
+			startProbe(&pr[HEADMISS][r]);
+			for (i = 0; i < BATCH; i++)
+				headBlocked(&bsem[BATCH + i]);
+			stopProbe(&pr[HEADMISS][r], BATCH);
+			startProbe(&pr[OUT][r]);	/* the second waiters */
+			for (i = 0; i < BATCH; i++)
+				outBlocked(pcbs[BATCH + i]);
+			stopProbe(&pr[OUT][r], BATCH);
+			startProbe(&pr[REMOVE][r]);	/* the first, deactivating */
+			for (i = 0; i < BATCH; i++)
+				removeBlocked(&bsem[i]);
+			stopProbe(&pr[REMOVE][r], BATCH);
+
+			/* broadcasts, one semaphore at a time and as a range */
+			for (i = 0; i < 2 * BATCH; i++)
+				insertBlocked(&bsem[i % BATCH], pcbs[i]);
+			tp = mkEmptyProcQ();
+			startProbe(&pr[REMOVEALL][r]);
+			for (i = 0; i < BATCH; i++)
+				removeAllBlocked(&bsem[i], &tp);
+			stopProbe(&pr[REMOVEALL][r], BATCH);
+			for (i = 0; i < 2 * BATCH; i++)
+				insertBlocked(&bsem[i % BATCH], pcbs[i]);
+			tp = mkEmptyProcQ();
+			startProbe(&pr[RANGE][r]);
+			removeBlockedRange(&bsem[0], &bsem[BATCH], &tp);
+			stopProbe(&pr[RANGE][r], BATCH);
+
+			startProbe(&pr[TIMED][r]);
+			for (i = 0; i < BATCH; i++)
+				insertBlockedTimed(&bsem[i], pcbs[i], &wheel, 1 + i);
+			stopProbe(&pr[TIMED][r], BATCH);
+			for (i = 0; i < BATCH; i++)
+				removeBlocked(&bsem[i]);
+
+			/* an interrupt handler's V on a device semaphore */
+			startProbe(&pr[DINSERT][r]);
+			for (i = 0; i < BATCH; i++)
+				insertBlocked(&devsem[i], pcbs[i]);
+			stopProbe(&pr[DINSERT][r], BATCH);
+			startProbe(&pr[DREMOVE][r]);
+			for (i = 0; i < BATCH; i++)
+				removeBlocked(&devsem[i]);
+			stopProbe(&pr[DREMOVE][r], BATCH);
+
+			/* P and V on free semaphores, then on taken ones */
+			for (i = 0; i < BATCH; i++)
+				bsem[i] = 1;
+			startProbe(&pr[PFAST][r]);
+			for (i = 0; i < BATCH; i++)
+				passeren(&bsem[i], pcbs[i]);
+			stopProbe(&pr[PFAST][r], BATCH);
+			startProbe(&pr[PBLOCK][r]);
+			for (i = 0; i < BATCH; i++)
+				passeren(&bsem[i], pcbs[BATCH + i]);
+			stopProbe(&pr[PBLOCK][r], BATCH);
+			startProbe(&pr[VWAKE][r]);
+			for (i = 0; i < BATCH; i++)
+				verhogen(&bsem[i]);
+			stopProbe(&pr[VWAKE][r], BATCH);
+			startProbe(&pr[VFAST][r]);
+			for (i = 0; i < BATCH; i++)
+				verhogen(&bsem[i]);
+			stopProbe(&pr[VFAST][r], BATCH);
+			for (i = 0; i < BATCH; i++)
+				bsem[i] = 0;
+		}
+	(void) tp;
+	report("asl", "insertBlocked/activate", n, pr[INSERT]);
+	report("asl", "insertBlocked/enqueue", n, pr[INSERTQ]);
+	report("asl", "headBlocked/hit", n, pr[HEAD]);
+	report("asl", "headBlocked/miss", n, pr[HEADMISS]);
+	report("asl", "outBlocked", n, pr[OUT]);
+	report("asl", "removeBlocked/deactivate", n, pr[REMOVE]);
+	report("asl", "removeAllBlocked", n, pr[REMOVEALL]);
+	report("asl", "removeBlockedRange/semaphore", n, pr[RANGE]);
+	report("asl", "insertBlockedTimed", n, pr[TIMED]);
+	report("asl", "insertBlocked/direct", n, pr[DINSERT]);
+	report("asl", "removeBlocked/direct", n, pr[DREMOVE]);
+	report("asl", "passeren/free", n, pr[PFAST]);
+	report("asl", "passeren/block", n, pr[PBLOCK]);
+	report("asl", "verhogen/wake", n, pr[VWAKE]);
+	report("asl", "verhogen/free", n, pr[VFAST]);
+}
+
+
+/* A priority-ordered semaphore queue of n waiters, with random priorities */
+HIDDEN void benchPrio(int n) {
+	enum { INSERT, HEAD, SETPRIO, BOOST, RESTORE, REMOVE, NP };
+	static probe_t pr[NP][16];
+	static int sem;
+	int r, k, i, rounds = roundsFor(n);
+	pcb_t *holder;
+
+	if (n + 1 > MAXPROC)
+		return;
+	memset(pr, 0, sizeof(pr));
+	resetAll();
+	holder = allocPcb();
+	for (i = 0; i < n; i++)
+		pcbs[i] = allocPcb();
+	shuffle(n);
+	for (r = 0; r < reps; r++)
+		for (k = 0; k < rounds; k++) {
+			for (i = 0; i < n; i++)
+				setPrio(pcbs[i], nextRand() % 32);
+			startProbe(&pr[INSERT][r]);
+			for (i = 0; i < n; i++)
+				insertBlockedPrio(&sem, pcbs[i]);
+			stopProbe(&pr[INSERT][r], n);
+			startProbe(&pr[HEAD][r]);
+			for (i = 0; i < n; i++)
+				headBlocked(&sem);
+			stopProbe(&pr[HEAD][r], n);
+			startProbe(&pr[SETPRIO][r]);	/* moves waiters up and down */
+			for (i = 0; i < n; i++)
+				setPrio(pcbs[perm[i]], nextRand() % 32);
+			stopProbe(&pr[SETPRIO][r], n);
+			startProbe(&pr[BOOST][r]);
+			for (i = 0; i < n; i++) {
+				setPrio(holder, 32);
+				boostPrio(holder, &sem);
+			}
+			stopProbe(&pr[BOOST][r], n);
+			startProbe(&pr[RESTORE][r]);
+			for (i = 0; i < n; i++)
+				restorePrio(holder);
+			stopProbe(&pr[RESTORE][r], n);
+			startProbe(&pr[REMOVE][r]);
+			for (i = 0; i < n; i++)
+				removeBlocked(&sem);
+			stopProbe(&pr[REMOVE][r], n);
+		}
+	report("prio", "insertBlockedPrio", n, pr[INSERT]);
+	report("prio", "headBlocked", n, pr[HEAD]);
+	report("prio", "setPrio/waiter", n, pr[SETPRIO]);
+	report("prio", "setPrio+boostPrio", n, pr[BOOST]);
+	report("prio", "restorePrio", n, pr[RESTORE]);
+	report("prio", "removeBlocked", n, pr[REMOVE]);
+}
+
+
+int main(int argc, char *argv[]) {
+	int i;
+	probe_t pr;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+			json = strcmp(argv[++i], "json") == 0;
+		else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+			reps = atoi(argv[++i]);
+		else {
+			fprintf(stderr, "usage: %s [-f csv|json] [-r reps]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (reps < 1 || reps > 16)
+		reps = 5;
+
+	/* the cost of the clock itself, taken off every timed region */
+	clockCost = 0;
+	memset(&pr, 0, sizeof(pr));
+	for (i = 0; i < 1000; i++) {
+		startProbe(&pr);
+		stopProbe(&pr, 1);
+	}
+	clockCost = pr.pr_ns / pr.pr_ops;
+
+	if (json)
+		printf("[");
+	else
+		printf("group,function,config,maxproc,n,ops,ns_per_op,visits_per_op\n");
+	for (i = 0; i < NSCALES; i++) {
+		if (scales[i] > MAXPROC)
+			continue;
+		benchPool(scales[i]);
+		benchQueue(scales[i]);
+		benchFanout(scales[i]);
+		benchDepth(scales[i]);
+		benchAsl(scales[i]);
+		benchPrio(scales[i]);
+	}
+	if (json)
+		printf("\n]\n");
+	return 0;
+}
@@ -0,0 +1,53 @@
+/**
+* @file libuarm.c
+* @brief Host replacements for the uARM library routines used by phase 1.
+* @details Lets the phase 1 modules and their test program run as ordinary
+* 				 processes, so they can be profiled and sanitized without the emulator.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "libuarm.h"
+
+/**
+* Write a string on the terminal; on the host, stdout.
+*
+* @param s The NUL-terminated string to print.
+*/
+void tprint(const char *s){
+
+	fputs(s, stdout);
+
+}
+
+
+/**
+* @brief Halt the machine.
+*
+* On the host this flushes pending output and aborts, so that a failing
+* test leaves a non-zero exit status (and a core, or a sanitizer report).
+*/
+void PANIC(void){
+
+	fflush(stdout);
+	fputs("PANIC\n", stderr);
+	abort();
+
+}
+
+
+/**
+* Read the low word of the time of day clock; on the host, microseconds
+* of a monotonic clock.
+*
+* @return The clock reading.
+*/
+unsigned int getTODLO(void){
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned int) (ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+
+}
@@ -6,11 +6,25 @@
 #define ASL_H
 /* Semaphore list handling functions */
 #include "pcb.h"
+#include "wheel.h"
 
 EXTERN void initSemd(void);
+EXTERN int growSemds(void *mem, unsigned int len);
+EXTERN int semdFreeCount(void);
+EXTERN int semdUsedCount(void);
+EXTERN int registerSemds(int *base, int n);
 EXTERN int insertBlocked(int *semAdd, pcb_t *p);
+EXTERN int insertBlockedPrio(int *semAdd, pcb_t *p);
+EXTERN int insertBlockedTimed(int *semAdd, pcb_t *p, wheel_t *w, unsigned int ticks);
 EXTERN pcb_t *removeBlocked(int *semAdd);
 EXTERN pcb_t *outBlocked(pcb_t *p);
 EXTERN pcb_t *headBlocked(int *semAdd);
+EXTERN int removeAllBlocked(int *semAdd, pcb_t **tp);
+EXTERN int removeBlockedRange(int *lo, int *hi, pcb_t **tp);
+EXTERN void setPrio(pcb_t *p, int prio);
+EXTERN int boostPrio(pcb_t *holder, int *semAdd);
+EXTERN void restorePrio(pcb_t *p);
+EXTERN int passeren(int *semAdd, pcb_t *p);
+EXTERN pcb_t *verhogen(int *semAdd);
 
 #endif
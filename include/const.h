@@ -9,9 +9,13 @@
 
 /**
 * Max number of overall (eg, system, daemons, user)
-* concurrent processes.
+* concurrent processes, i.e. the number of ProcBlk's and of
+* semaphore descriptors available at boot. Can be set at
+* build time; both pools can be grown further at run time.
 */
+#ifndef MAXPROC
 #define MAXPROC 20
+#endif
 
 /**
 * number of usermode processes (not including maste
@@ -19,6 +23,54 @@
 */
 #define UPROCMAX 3  
 
+/**
+* Number of process identifiers: only the first MAXPIDS
+* ProcBlk's ever allocated get one, so raise it along with
+* growPcbs(). At most 65536.
+*/
+#ifndef MAXPIDS
+#define MAXPIDS MAXPROC
+#endif
+
+/**
+* Number of cores of the multicore (KAYA_SMP) build.
+*/
+#ifndef MAXCPU
+#define MAXCPU 4
+#endif
+
+/**
+* Free ProcBlk's each core keeps for itself in the
+* multicore build.
+*/
+#define PCBCACHE 8
+
+/**
+* Number of priority levels of the multi-level feedback
+* ready queue (at most 32), level 0 being the highest.
+*/
+#define MLFQLEVELS 8
+
+/**
+* Ticks a process may run at MLFQ level 0 before being
+* demoted; each level below doubles the quantum.
+*/
+#define MLFQQUANTUM 1
+
+/**
+* Number of levels of a timing wheel; each level has 64
+* slots, so 4 levels hold timeouts of up to 2^24 ticks.
+*/
+#define WHEELLEVELS 4
+
+/**
+* Semaphore descriptors set aside for direct-indexed
+* semaphore arrays (device semaphores and the pseudo-clock),
+* and the number of such arrays that can be registered.
+*/
+#define DIRECTSEMDS 64
+#define DIRECTRANGES 4
+
 
 /* general purpose constants */
 #define EXTERN extern
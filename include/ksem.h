@@ -0,0 +1,27 @@
+/**
+* @file ksem.h
+* @brief Kernel semaphore object declarations.
+*/
+#ifndef KSEM_H
+#define KSEM_H
+
+#include "pcb.h"
+#include "spinlock.h"
+
+/**
+* @brief A semaphore holding its own wait queue, so that blocking and
+* waking on it need no ASL descriptor and no lookup.
+*/
+typedef struct ksem_t {
+	int ks_value;		/* negative when -ks_value processes wait */
+	pcb_t *ks_procQ;	/* tail pointer of the waiters' ProcQ */
+	spinlock_t ks_lock;	/* guards ks_value and ks_procQ under KAYA_SMP */
+} ksem_t;
+
+EXTERN void initKsem(ksem_t *ks, int value);
+EXTERN int passerenKsem(ksem_t *ks, pcb_t *p);
+EXTERN pcb_t *verhogenKsem(ksem_t *ks);
+EXTERN int broadcastKsem(ksem_t *ks, pcb_t **tp);
+EXTERN pcb_t *outKsem(pcb_t *p);
+
+#endif
@@ -0,0 +1,25 @@
+/**
+* @file lfstack.h
+* @brief Lock-free stack declarations.
+*/
+#ifndef LFSTACK_H
+#define LFSTACK_H
+
+#include "const.h"
+
+/**
+* @brief A lock-free (Treiber) stack of objects linked through their first word.
+*
+* The head packs the top object's address with a generation tag that
+* changes on every push and pop, so that a compare-and-swap against a head
+* read before an object was popped and pushed back fails (the ABA problem).
+*/
+typedef struct lfstack_t {
+	volatile unsigned long long lf_head;	/* tagged address of the top object */
+} lfstack_t;
+
+EXTERN void initLfStack(lfstack_t *ls);
+EXTERN void pushLfStack(lfstack_t *ls, void *obj);
+EXTERN void *popLfStack(lfstack_t *ls);
+
+#endif
@@ -3,6 +3,10 @@
 
 void tprint(const char *s);
 
+void PANIC(void);
+
+unsigned int getTODLO(void);
+
 extern unsigned int LDST(void *addr);
 
 #endif //UARM_LIBURAM_H
@@ -0,0 +1,34 @@
+/**
+* @file mlfq.h
+* @brief Multi-level feedback ready queue declarations.
+*/
+#ifndef MLFQ_H
+#define MLFQ_H
+
+#include "pcb.h"
+
+#if MLFQLEVELS > 32
+#error "MLFQLEVELS must fit in the bitmap of non-empty levels"
+#endif
+
+/* Quantum, in ticks, of a process at a given level */
+#define MLFQ_QUANTUM(level) (MLFQQUANTUM << (level))
+
+/**
+* @brief Multi-level feedback queue data type.
+*/
+typedef struct mlfq_t {
+	pcb_t *mq_level[MLFQLEVELS];	/* tail pointers of the levels' ProcQs */
+	unsigned int mq_busy;		/* bit i is set if mq_level[i] is non-empty (cleared lazily, see mlfq.c) */
+} mlfq_t;
+
+EXTERN void initMlfq(mlfq_t *mq);
+EXTERN int emptyMlfq(mlfq_t *mq);
+EXTERN void insertMlfq(mlfq_t *mq, pcb_t *p);
+EXTERN pcb_t *removeMlfq(mlfq_t *mq);
+EXTERN pcb_t *outMlfq(mlfq_t *mq, pcb_t *p);
+EXTERN pcb_t *headMlfq(mlfq_t *mq);
+EXTERN int chargeMlfq(pcb_t *p, int ticks);
+EXTERN void boostMlfq(mlfq_t *mq);
+
+#endif
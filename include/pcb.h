@@ -13,24 +13,139 @@
 
 /* process control block type */
 
+struct semd_t;	/* semaphore descriptor, private to the ASL */
+
+typedef unsigned long long cputime_t;	/* CPU time, in ticks of the caller's choosing */
+
+
+/*
+* The links between ProcBlk's and the scheduling fields are read and
+* written only through PCBLINK(), SETPCBLINK() and PCBHOT(), so that they
+* can be laid out in one of two ways.
+*
+* By default they are ordinary pointer and integer fields of pcb_t.
+*
+* With PCB_COMPACT defined they move out of pcb_t into pcbHot[], a dense
+* array parallel to the static table of ProcBlk's, where links are 16 bit
+* indices into that table: a ProcBlk's link data takes 28 bytes on uARM,
+* so two fit in a cache line, and queue or tree walks no longer pull the
+* processor state into the cache. In this layout every ProcBlk must come
+* from pcbTable, so growPcbs() adds nothing.
+*/
+#ifdef PCB_COMPACT
+
+#if MAXPROC >= 0xFFFF
+#error "PCB_COMPACT indices are 16 bit wide"
+#endif
+
+typedef unsigned short pcbidx_t;	/* index in pcbTable */
+
+#define PCBNIL 0xFFFF			/* index standing for NULL */
+
+/**
+* @brief Hot part of a ProcBlk: links and scheduling fields.
+*/
+typedef struct pcbhot_t {
+	/* Queue management */
+	pcbidx_t p_next;
+	pcbidx_t p_prev;	/* PCBNIL iff the ProcBlk is on no queue */
+	struct pcb_t **p_q;	/* tail pointer of the ProcQ p is the tail of, else NULL */
+
+	/* Process Tree management */
+	pcbidx_t p_prnt;
+	pcbidx_t p_child;
+	pcbidx_t p_sib;
+	pcbidx_t p_sprv;	/* previous sibling; the first child's is the last child */
+
+	/* Priority-ordered semaphore queues */
+	pcbidx_t p_hchild;	/* first child in the waiters' heap */
+
+	/* Scheduling */
+	short p_level;		/* MLFQ priority level, 0 is the highest */
+	short p_rq;		/* core whose run queue holds the ProcBlk, or -1 */
+	int p_ticks;		/* ticks used at p_level */
+} pcbhot_t;
+
+#endif
+
 
 /**
 * @brief Process Control Block data type.
 */
 typedef struct pcb_t {
+#ifndef PCB_COMPACT
 	/* Queue management */
 	struct pcb_t *p_next;
+	struct pcb_t *p_prev;	/* NULL iff the ProcBlk is on no queue */
+	struct pcb_t **p_q;	/* tail pointer of the ProcQ p is the tail of, else NULL */
 
 	/* Process Tree management */
 	struct pcb_t *p_prnt;
 	struct pcb_t *p_child;
 	struct pcb_t *p_sib;
+	struct pcb_t *p_sprv;	/* previous sibling; the first child's is the last child */
+
+	/* Priority-ordered semaphore queues */
+	struct pcb_t *p_hchild;	/* first child in the waiters' heap */
+	
+	/* Scheduling */
+	int p_level;	/* MLFQ priority level, 0 is the highest */
+	int p_rq;	/* core whose run queue holds the ProcBlk, or -1 */
+	int p_ticks;	/* ticks used at p_level */
+#endif
 	
 	state_t p_s;	/* Processor state */
 	int *p_semAdd;	/* Active semaphore Key */
+	struct semd_t *p_semd;	/* descriptor p is blocked on, or NULL */
+	unsigned int p_semgen;	/* generation of p_semd when p blocked */
+	struct ksem_t *p_ksem;	/* ksem_t p is blocked on, or NULL; see ksem.h */
+	int p_prio;		/* base priority, 0 is the highest */
+	int p_eprio;		/* effective priority, raised by inheritance */
+	unsigned int p_hseq;	/* arrival stamp in a priority-ordered queue */
+
+	/* Timers: only touched when a timer is armed, cancelled or
+	 * expires, so they stay here in both layouts */
+	struct pcb_t *p_tnext;	/* next ProcBlk in the same timing wheel slot */
+	struct pcb_t *p_tprev;
+	struct pcb_t **p_tslot;	/* tail pointer of that slot, NULL iff no timer is armed */
+	unsigned int p_wake;	/* tick the timer expires at */
+	int p_twait;		/* TRUE iff the timer is a semaphore timeout */
+
+	int p_cpu;		/* core whose run queue last handed the ProcBlk out */
+	unsigned int p_pid;	/* process identifier, see pid.h; kept across frees */
+
+	/* CPU time accounting: p_subtime is p_cputime plus p_childtime plus
+	 * the p_subtime of every child, kept up to date by the tree functions */
+	cputime_t p_cputime;	/* time charged to the process itself */
+	cputime_t p_childtime;	/* time of descendants that exited, see reapChild() */
+	cputime_t p_subtime;	/* time of the whole subtree */
 } pcb_t;
 
 
+#ifdef PCB_COMPACT
+
+EXTERN pcb_t pcbTable[MAXPROC];
+EXTERN pcbhot_t pcbHot[MAXPROC];
+
+#define PCBIDX(p) ((p) == NULL ? PCBNIL : (pcbidx_t) ((pcb_t *) (p) - pcbTable))
+#define PCBPTR(i) ((i) == PCBNIL ? (pcb_t *) NULL : &pcbTable[i])
+
+#define PCBLINK(p, f) PCBPTR(pcbHot[(p) - pcbTable].f)
+#define SETPCBLINK(p, f, q) (pcbHot[(p) - pcbTable].f = PCBIDX(q))
+#define PCBHOT(p, f) (pcbHot[(p) - pcbTable].f)
+
+#else
+
+/* Link field f of the ProcBlk p, as a pointer */
+#define PCBLINK(p, f) ((p)->f)
+/* Set link field f of the ProcBlk p to point to q */
+#define SETPCBLINK(p, f, q) ((p)->f = (q))
+/* Scheduling field f of the ProcBlk p, as an lvalue */
+#define PCBHOT(p, f) ((p)->f)
+
+#endif
+
+
 /* PCB handling functions */
 
 /* List view functions */
@@ -38,19 +153,39 @@ typedef struct pcb_t {
 EXTERN void freePcb(pcb_t *p);
 EXTERN pcb_t *allocPcb(void);
 EXTERN void initPcbs(void);
+EXTERN int growPcbs(void *mem, unsigned int len);
+EXTERN int pcbFreeCount(void);
+EXTERN int pcbUsedCount(void);
+EXTERN int pcbIndex(pcb_t *p);
+#ifdef KAYA_SMP
+EXTERN pcb_t *allocPcbSMP(int cpu);
+EXTERN void freePcbSMP(int cpu, pcb_t *p);
+EXTERN void flushPcbCache(int cpu);
+#endif
 EXTERN pcb_t *mkEmptyProcQ(void);
 EXTERN int emptyProcQ(pcb_t *tp);
 EXTERN void insertProcQ(pcb_t **tp, pcb_t *p);
 EXTERN pcb_t *removeProcQ(pcb_t **tp);
 EXTERN pcb_t *outProcQ(pcb_t **tp, pcb_t *p);
+EXTERN pcb_t *leaveProcQ(pcb_t *p);
 EXTERN pcb_t *headProcQ(pcb_t *tp);
+EXTERN void concatProcQ(pcb_t **tp, pcb_t **sp);
+EXTERN int splitProcQ(pcb_t **tp, pcb_t **sp, int n);
 
 /* Tree view functions */
 
 EXTERN void initASL(void);
 EXTERN int emptyChild(pcb_t *p);
 EXTERN void insertChild(pcb_t *prnt, pcb_t *p);
+EXTERN void insertChildHead(pcb_t *prnt, pcb_t *p);
 EXTERN pcb_t *removeChild(pcb_t *p);
 EXTERN pcb_t *outChild(pcb_t *p);
+EXTERN pcb_t *reapChild(pcb_t *p);
+
+/* CPU time accounting functions */
+
+EXTERN void chargeTime(pcb_t *p, cputime_t t);
+EXTERN cputime_t cpuTime(pcb_t *p);
+EXTERN cputime_t subtreeTime(pcb_t *p);
 
 #endif
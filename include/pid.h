@@ -0,0 +1,32 @@
+/**
+* @file pid.h
+* @brief Process identifier declarations.
+*/
+#ifndef PID_H
+#define PID_H
+
+#include "pcb.h"
+
+/**
+* @brief A process identifier: the ProcBlk's slot in the PID table in the
+* low PIDSLOTBITS bits, the generation of the slot in the others.
+*/
+typedef unsigned int kpid_t;
+
+#define PIDSLOTBITS 16
+#define PIDSLOTMASK ((1u << PIDSLOTBITS) - 1)
+
+/* A process identifier that never names a process */
+#define PIDNONE 0
+
+#if MAXPIDS > (1 << PIDSLOTBITS)
+#error "MAXPIDS must fit in PIDSLOTBITS bits"
+#endif
+
+EXTERN void initPids(void);
+EXTERN void assignPid(pcb_t *p);
+EXTERN void releasePid(pcb_t *p);
+EXTERN kpid_t pcbPid(pcb_t *p);
+EXTERN pcb_t *pidPcb(kpid_t pid);
+
+#endif
@@ -0,0 +1,12 @@
+/**
+* @file proc.h
+* @brief Process lifetime operations spanning queues, tree and ASL.
+*/
+#ifndef PROC_H
+#define PROC_H
+
+#include "pcb.h"
+
+EXTERN int terminateSubtree(pcb_t *root);
+
+#endif
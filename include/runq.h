@@ -0,0 +1,29 @@
+/**
+* @file runq.h
+* @brief Per-core run queue declarations.
+*/
+#ifndef RUNQ_H
+#define RUNQ_H
+
+#include "pcb.h"
+#include "spinlock.h"
+
+/**
+* @brief Run queue of a core: a ProcQ of ready processes and its lock.
+*/
+typedef struct runq_t {
+	pcb_t *rq_tail;		/* tail pointer of the ready ProcQ */
+	int rq_count;		/* ProcBlks on rq_tail, read unlocked by thieves */
+	spinlock_t rq_lock;	/* serializes the owner and thieves */
+	char rq_pad[64];	/* keep other cores' queues off this line */
+} runq_t;
+
+EXTERN void initRunQs(void);
+EXTERN void insertRunQ(int cpu, pcb_t *p);
+EXTERN pcb_t *removeRunQ(int cpu);
+EXTERN pcb_t *outRunQ(int cpu, pcb_t *p);
+EXTERN int findRunQ(pcb_t *p);
+EXTERN int stealRunQ(int cpu);
+EXTERN int runQCount(int cpu);
+
+#endif
@@ -0,0 +1,47 @@
+/**
+* @file slab.h
+* @brief Slab allocator declarations.
+*/
+#ifndef SLAB_H
+#define SLAB_H
+
+#include "const.h"
+
+/* Alignment of the objects carved from a memory region */
+#define SLABALIGN 8
+
+/**
+* @brief A slab: a contiguous run of equally sized objects.
+*/
+typedef struct slab_t {
+	struct slab_t *sl_next;	/* next slab of the same pool */
+	char *sl_base;		/* first object of the slab */
+	unsigned int sl_count;	/* number of objects in the slab */
+	char *sl_fresh;		/* first object never handed out */
+	char *sl_end;		/* just past the last object */
+} slab_t;
+
+/**
+* @brief A pool of fixed size objects, made of one or more slabs.
+*
+* Objects that have been freed are kept on a list linked through their
+* first word, so an object's first field is overwritten while it is free.
+* Objects never allocated are not on the list: they are handed out in
+* order from the slabs, through sl_fresh, once the list is empty.
+*/
+typedef struct pool_t {
+	void *po_free;		/* head of the list of freed objects */
+	slab_t *po_slabs;	/* slabs of the pool, most recent first */
+	slab_t *po_fresh;	/* slab to hand never used objects out of */
+	unsigned int po_size;	/* object size, in bytes */
+	unsigned int po_total;	/* number of objects in all the slabs */
+	unsigned int po_used;	/* number of objects currently allocated */
+} pool_t;
+
+EXTERN void initPool(pool_t *po, unsigned int size);
+EXTERN void addSlab(pool_t *po, slab_t *sl, void *objs, unsigned int count);
+EXTERN int growPool(pool_t *po, void *mem, unsigned int len);
+EXTERN void *allocPool(pool_t *po);
+EXTERN void freePool(pool_t *po, void *obj);
+
+#endif
@@ -0,0 +1,35 @@
+/**
+* @file spinlock.h
+* @brief Spin locks for the multicore (KAYA_SMP) build.
+* @details Without KAYA_SMP the kernel runs on a single core and every lock
+* 				 operation compiles to nothing.
+*/
+#ifndef SPINLOCK_H
+#define SPINLOCK_H
+
+typedef volatile unsigned char spinlock_t;
+
+#define SPINUNLOCKED 0
+
+#ifdef KAYA_SMP
+
+/* Acquire l, spinning on plain loads while it is held elsewhere */
+static inline void spinLock(spinlock_t *l){
+	while(__atomic_test_and_set(l, __ATOMIC_ACQUIRE))
+		while(__atomic_load_n(l, __ATOMIC_RELAXED))
+			;
+}
+
+/* Release l */
+static inline void spinUnlock(spinlock_t *l){
+	__atomic_clear(l, __ATOMIC_RELEASE);
+}
+
+#else
+
+#define spinLock(l) ((void) 0)
+#define spinUnlock(l) ((void) 0)
+
+#endif
+
+#endif
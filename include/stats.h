@@ -0,0 +1,87 @@
+/**
+* @file stats.h
+* @brief Operation counters of the phase 1 modules.
+* @details Counting is compiled in only when KAYA_STATS is defined; otherwise
+* 				 the STAT macros expand to nothing and every counter stays 0.
+*/
+#ifndef STATS_H
+#define STATS_H
+
+#include "const.h"
+
+/**
+* @brief Counters and high-water marks of the phase 1 modules.
+*/
+typedef struct kstats_t {
+	/* ProcBlk allocation */
+	unsigned long st_pcbAllocs;	/* successful allocPcb()'s */
+	unsigned long st_pcbAllocFails;	/* allocPcb()'s on an empty pcbFree list */
+	unsigned long st_pcbFrees;	/* freePcb()'s */
+	unsigned long st_pcbPeak;	/* most ProcBlk's allocated at once */
+	unsigned long st_pcbInUse;	/* ProcBlk's allocated now (snapshot only) */
+	unsigned long st_pcbAvail;	/* ProcBlk's free now (snapshot only) */
+
+	/* Process queues */
+	unsigned long st_qInserts;	/* insertProcQ()'s */
+	unsigned long st_qRemoves;	/* removeProcQ()'s on a non-empty queue */
+	unsigned long st_qOuts;		/* successful outProcQ()'s */
+	unsigned long st_qOutFails;	/* outProcQ()'s of a ProcBlk not queued */
+	unsigned long st_qConcats;	/* concatProcQ()'s */
+
+	/* Process trees */
+	unsigned long st_childInserts;	/* insertChild()'s */
+	unsigned long st_childRemoves;	/* removeChild()'s of an existing child */
+	unsigned long st_childOuts;	/* outChild()'s of a ProcBlk with a parent */
+
+	/* Active Semaphore List */
+	unsigned long st_aslInserts;	/* successful insertBlocked()'s */
+	unsigned long st_aslInsertFails; /* insertBlocked()'s out of descriptors */
+	unsigned long st_aslRemoves;	/* removeBlocked()'s of an active semaphore */
+	unsigned long st_aslOuts;	/* successful outBlocked()'s */
+	unsigned long st_aslOutFails;	/* outBlocked()'s of a ProcBlk not blocked */
+	unsigned long st_aslHeads;	/* headBlocked()'s */
+	unsigned long st_aslRemoveAlls;	/* removeAllBlocked()'s of an active semaphore */
+	unsigned long st_aslLookups;	/* ASL searches */
+	unsigned long st_aslMisses;	/* ASL searches for an inactive semaphore */
+	unsigned long st_aslVisits;	/* descriptors (or array entries) visited by them */
+	unsigned long st_aslDirect;	/* lookups answered by a direct-indexed array instead */
+	unsigned long st_semdPeak;	/* most semaphores active at once */
+	unsigned long st_semdInUse;	/* semaphores active now (snapshot only) */
+	unsigned long st_semdAvail;	/* free descriptors now (snapshot only) */
+	unsigned long st_semQueuePeak;	/* longest semaphore queue */
+	unsigned long st_semFast;	/* passeren()/verhogen()'s that did not touch the ASL */
+} kstats_t;
+
+#ifdef KAYA_STATS
+
+EXTERN kstats_t kstats;
+
+#ifdef KAYA_SMP
+#define STATINC(f) __atomic_fetch_add(&kstats.f, 1, __ATOMIC_RELAXED)
+#define STATADD(f, n) __atomic_fetch_add(&kstats.f, (n), __ATOMIC_RELAXED)
+/* raise a high-water mark, retrying if another core raised it meanwhile */
+#define STATMAX(f, v) do { \
+		unsigned long m_ = (v), o_ = __atomic_load_n(&kstats.f, __ATOMIC_RELAXED); \
+		while (m_ > o_ && !__atomic_compare_exchange_n(&kstats.f, &o_, m_, 1, \
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED)) \
+			; \
+	} while (0)
+#else
+#define STATINC(f) (kstats.f++)
+#define STATADD(f, n) (kstats.f += (n))
+#define STATMAX(f, v) do { if ((unsigned long) (v) > kstats.f) kstats.f = (v); } while (0)
+#endif
+
+#else
+
+#define STATINC(f) ((void) 0)
+#define STATADD(f, n) ((void) 0)
+#define STATMAX(f, v) ((void) 0)
+
+#endif
+
+EXTERN void getStats(kstats_t *st);
+EXTERN void resetStats(void);
+EXTERN void dumpStats(void);
+
+#endif
@@ -0,0 +1,68 @@
+/**
+* @file trace.h
+* @brief Event trace declarations.
+*/
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "pcb.h"
+
+/**
+* Number of events the trace ring holds (a power of two); once it is
+* full, each new event overwrites the oldest.
+*/
+#ifndef TRACESIZE
+#define TRACESIZE 4096
+#endif
+
+#if TRACESIZE & (TRACESIZE - 1)
+#error "TRACESIZE must be a power of two"
+#endif
+
+/* Event types */
+#define TR_ALLOC 1		/* ProcBlk allocated */
+#define TR_FREE 2		/* ProcBlk freed */
+#define TR_QINSERT 3		/* ProcBlk queued; te_arg is the queue's tail pointer address */
+#define TR_QREMOVE 4		/* ProcBlk dequeued; te_arg as above */
+#define TR_QCONCAT 5		/* queue headed by te_pcb appended to queue te_arg */
+#define TR_BLOCK 6		/* ProcBlk blocked on semaphore te_arg */
+#define TR_UNBLOCK 7		/* ProcBlk unblocked from semaphore te_arg */
+#define TR_UNBLOCKALL 8		/* every ProcBlk blocked on semaphore te_arg unblocked */
+#define TR_CHILD 9		/* ProcBlk made a child of ProcBlk te_arg */
+#define TR_ORPHAN 10		/* ProcBlk removed from the children of ProcBlk te_arg */
+
+/**
+* @brief A trace event, 16 bytes in every build.
+*/
+typedef struct trevent_t {
+	unsigned int te_time;		/* getTODLO() when the event was recorded */
+	unsigned int te_pcb;		/* pool index of the ProcBlk, see tracePcb() */
+	unsigned int te_arg;		/* depends on te_type */
+	unsigned short te_type;		/* one of TR_* */
+	unsigned short te_pad;
+} trevent_t;
+
+/**
+* @brief Header of the image written by dumpTrace(), followed by
+* th_count events, oldest first.
+*/
+typedef struct trheader_t {
+	char th_magic[4];		/* "KTRC" */
+	unsigned int th_count;		/* events in the image */
+	unsigned int th_lost;		/* older events overwritten before the dump */
+	unsigned int th_size;		/* TRACESIZE */
+} trheader_t;
+
+#ifdef KAYA_TRACE
+#define TRACE(type, p, obj) traceEvent((type), (p), (obj))
+#else
+#define TRACE(type, p, obj) ((void) 0)
+#endif
+
+EXTERN void traceEvent(int type, pcb_t *p, const void *obj);
+EXTERN unsigned int tracePcb(pcb_t *p);
+EXTERN void resetTrace(void);
+EXTERN int readTrace(trevent_t *ev, int max);
+EXTERN unsigned int dumpTrace(void *buf, unsigned int len);
+
+#endif
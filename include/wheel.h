@@ -0,0 +1,39 @@
+/**
+* @file wheel.h
+* @brief Timing wheel declarations.
+*/
+#ifndef WHEEL_H
+#define WHEEL_H
+
+#include "pcb.h"
+
+/* Each level of the wheel has 1 << WHEELBITS slots */
+#define WHEELBITS 6
+#define WHEELSLOTS (1 << WHEELBITS)
+#define WHEELMASK (WHEELSLOTS - 1)
+
+/* Longest timeout, in ticks, that the WHEELLEVELS levels can hold */
+#define WHEELMAX ((1u << (WHEELBITS * WHEELLEVELS)) - 1)
+
+#if WHEELBITS * WHEELLEVELS > 30
+#error "the timing wheel must span less than 2^30 ticks"
+#endif
+
+/**
+* @brief Hierarchical timing wheel data type.
+*
+* Slot i of level l holds the ProcBlks due in a tick whose bits
+* [l*WHEELBITS, (l+1)*WHEELBITS) equal i, and at most
+* 1 << ((l+1)*WHEELBITS) ticks ahead.
+*/
+typedef struct wheel_t {
+	pcb_t *tw_slot[WHEELLEVELS][WHEELSLOTS];	/* tail pointers of the slots' timer queues */
+	unsigned int tw_now;				/* ticks elapsed since initWheel() */
+} wheel_t;
+
+EXTERN void initWheel(wheel_t *w);
+EXTERN void insertWheel(wheel_t *w, pcb_t *p, unsigned int ticks);
+EXTERN pcb_t *outWheel(pcb_t *p);
+EXTERN int tickWheel(wheel_t *w, pcb_t **tp);
+
+#endif
@@ -1,7 +1,7 @@
 /**
 * @file asl.c
 * @brief Function definitions for handling the Active Semaphore List
-* @details This file contains the implementation of the Active Semaphore List data structure and the necessary functions to allocate semaphores and manage their associated ProcQs.
+* @details This file contains the implementation of the Active Semaphore List data structure, a hash table of semaphore descriptors keyed on the semaphore address, and the necessary functions to allocate semaphores and manage their associated ProcQs.
 * @author Patrizia Thomas
 * @author Eduardo Santarelli
 * @version 0.1
@@ -10,38 +10,851 @@
 #include "asl.h" 
 #include "const.h"
 #include "libuarm.h"
+#include "slab.h"
+#include "stats.h"
+#include "lfstack.h"
+#include "spinlock.h"
+#include "wheel.h"
+#include "trace.h"
 
 /* semaphore descriptor type */ 
 typedef struct semd_t { 
-	struct semd_t *s_next; /* next element on the ASL */ 
+	struct semd_t *s_next; /* next element on the hash chain or semdFree list */ 
 	int *s_semAdd;         /* pointer to the semaphore */ 
-	pcb_t *s_procQ;        /* tail pointer to a process queue */
+	pcb_t *s_procQ;        /* tail pointer to a process queue, or root of its heap if s_prio */
+	int s_count;           /* number of ProcBlks on s_procQ */
+	int s_prio;            /* TRUE iff s_procQ is ordered by priority */
+	unsigned int s_seq;    /* arrival stamp of the next waiter, if s_prio */
+	int s_timed;           /* how many of them have a timeout armed */
+	unsigned int s_gen;    /* bumped whenever s_procQ is detached whole */
 } semd_t;
- 
 
-HIDDEN semd_t *semd_h, /* head of the ASL */
-	      *semdFree_h; /* head of the semdFree list */
+
+/*
+* Two interchangeable indexes of the active descriptors are available; both
+* sit behind findSemd(), linkSemd() and unlinkSemd().
+*
+* By default the ASL is a hash table keyed on s_semAdd, with descriptors
+* chained through s_next. The number of buckets is the smallest power of
+* two not below MAXPROC, so with every descriptor active the load factor is
+* at most one and a lookup is expected to visit about one descriptor.
+*
+* With ASL_SORTED defined, the ASL is instead a contiguous array of the
+* active semaphore addresses kept in ascending order, searched by bisection,
+* with a parallel array of descriptor pointers. The probes only touch the
+* dense key array, and a range of addresses is a run of adjacent entries.
+* The array holds at most MAXPROC active semaphores, so growSemds() adds
+* no descriptors in this layout.
+*/
+#ifndef ASL_SORTED
+
+#if MAXPROC <= 16
+#define ASLHASHBITS 4
+#elif MAXPROC <= 32
+#define ASLHASHBITS 5
+#elif MAXPROC <= 64
+#define ASLHASHBITS 6
+#elif MAXPROC <= 128
+#define ASLHASHBITS 7
+#elif MAXPROC <= 256
+#define ASLHASHBITS 8
+#elif MAXPROC <= 512
+#define ASLHASHBITS 9
+#elif MAXPROC <= 1024
+#define ASLHASHBITS 10
+#elif MAXPROC <= 2048
+#define ASLHASHBITS 11
+#elif MAXPROC <= 4096
+#define ASLHASHBITS 12
+#elif MAXPROC <= 8192
+#define ASLHASHBITS 13
+#elif MAXPROC <= 16384
+#define ASLHASHBITS 14
+#elif MAXPROC <= 32768
+#define ASLHASHBITS 15
+#else
+#define ASLHASHBITS 16
+#endif
+
+#define ASLHASHSIZE (1 << ASLHASHBITS)
+
+/* Fibonacci hashing of the semaphore's word address: consecutive
+ * semaphores (e.g. a device array) land in distinct buckets */
+#define ASLHASH(semAdd) \
+	((unsigned int)((unsigned long)(semAdd) >> 2) * 2654435761u >> (32 - ASLHASHBITS))
+
+HIDDEN semd_t *semdHash[ASLHASHSIZE]; /* buckets of the ASL */
+
+#else
+
+#ifdef KAYA_SMP
+#error "the sorted ASL has no concurrent mode: build KAYA_SMP without ASL_SORTED"
+#endif
+
+HIDDEN int *semdKey[MAXPROC];	   /* active semaphore addresses, ascending */
+HIDDEN semd_t *semdVal[MAXPROC];   /* semdVal[i] is the descriptor of semdKey[i] */
+HIDDEN int semdCount;		   /* number of active descriptors */
+
+#endif
+
+HIDDEN pool_t semdPool; /* the semdFree list, and the slabs of descriptors it draws from */
+
+/*
+* Direct-indexed semaphores. registerSemds() binds an array of semaphores,
+* such as the device semaphores, to a run of descriptors of directTable,
+* so that semaphore base[i] always has descriptor i of the run: these
+* semaphores are never looked up in the ASL index, and their descriptors
+* never leave or rejoin the semdFree list. A direct descriptor is active
+* while its queue is not empty. A single comparison against the bounds
+* of all the arrays keeps the other semaphores off this path.
+*/
+
+/**
+* @brief A registered array of direct-indexed semaphores.
+*/
+typedef struct directrange_t {
+	int *dr_lo;		/* the first semaphore of the array */
+	int *dr_hi;		/* just past its last one */
+	semd_t *dr_semd;	/* descriptor of dr_lo; the others follow */
+} directrange_t;
+
+HIDDEN semd_t directTable[DIRECTSEMDS];		/* descriptors of the direct semaphores */
+HIDDEN directrange_t directRange[DIRECTRANGES];	/* the registered arrays */
+HIDDEN int directCount;				/* number of registered arrays */
+HIDDEN int directUsed;				/* descriptors of directTable bound so far */
+HIDDEN int *directLo, *directHi;		/* bounds of all the arrays together */
+
+#define ISDIRECT(s) ((s) >= directTable && (s) < directTable + DIRECTSEMDS)
+
+#ifdef KAYA_SMP
+
+/*
+* Multicore ASL. Every hash bucket has its own spin lock, which covers the
+* bucket's chain and the descriptors on it (their process queues and
+* counts), so only operations on semaphores hashing to the same bucket
+* contend. Freed descriptors go to a shared lock-free stack; only when it
+* is empty does a core take semdPoolLock and carve a fresh descriptor out
+* of semdPool. A ProcBlk handed to an ASL function must not be handled by
+* another core at the same time.
+*/
+
+/**
+* @brief The lock of a hash bucket, alone on its cache line.
+*/
+typedef struct bucketlock_t {
+	spinlock_t bl_lock;
+	char bl_pad[63];	/* keep neighbouring buckets' locks off this line */
+} bucketlock_t;
+
+HIDDEN bucketlock_t semdLock[ASLHASHSIZE];	/* semdLock[i] guards semdHash[i] */
+HIDDEN lfstack_t semdShared;			/* descriptors freed since they were carved */
+HIDDEN int semdActive;				/* descriptors handed out, or fewer while one changes hands */
+HIDDEN spinlock_t semdPoolLock = SPINUNLOCKED;	/* serializes access to semdPool */
+
+#define LOCKSEMD(semAdd) spinLock(&semdLock[ASLHASH(semAdd)].bl_lock)
+#define UNLOCKSEMD(semAdd) spinUnlock(&semdLock[ASLHASH(semAdd)].bl_lock)
+
+#else
+
+#define LOCKSEMD(semAdd) ((void) 0)
+#define UNLOCKSEMD(semAdd) ((void) 0)
+
+#endif
 
 
 /* ASL functions */
 
 /* Initialize the semdFree list to contain all the elements of the array
-static semd t semdTable[MAXPROC] */
+static semd t semdTable[MAXPROC], in constant time (see slab.c) */
 void initASL(void){ 
-	int i;	
-	static semd_t semdTable[MAXPROC+1]; /*I declare an extra element to use as a dummy node */
+	static semd_t semdTable[MAXPROC];
+	static slab_t semdSlab;
 	
-	/*build a list out of the elements in semdTable */
-	semdFree_h = &(semdTable[0]);
-	for (i = 0; i < MAXPROC-1; i++)
-		semdTable[i].s_next = &(semdTable[i+1]);			
-	semdTable[i].s_next = NULL;	
-	semd_h = &semdTable[MAXPROC]; /*Keep the last item as the head(dummy node)*/
+	initPool(&semdPool, sizeof(semd_t));
+	addSlab(&semdPool, &semdSlab, semdTable, MAXPROC);
+#ifdef KAYA_SMP
+	initLfStack(&semdShared);
+	semdActive = 0;
+#endif
+	initSemd();
+}
+
+
+/* Add the descriptors carved out of the memory region [mem, mem+len)
+to the semdFree list, and return how many were added. With ASL_SORTED
+the array only has room for MAXPROC active semaphores, so none are */
+int growSemds(void *mem, unsigned int len){ 
+#ifndef ASL_SORTED
+	int n;
+
+	spinLock(&semdPoolLock);
+	n = growPool(&semdPool, mem, len);
+	spinUnlock(&semdPoolLock);
+	return n;
+#else
+	(void) mem;
+	(void) len;
+	return 0;
+#endif
+}
+
+
+/* Return the number of descriptors on the semdFree list */
+int semdFreeCount(void){ 
+#ifdef KAYA_SMP
+	return semdPool.po_total - __atomic_load_n(&semdActive, __ATOMIC_RELAXED);
+#else
+	return semdPool.po_total - semdPool.po_used;
+#endif
+}
+
+
+/* Return the number of active descriptors */
+int semdUsedCount(void){ 
+#ifdef KAYA_SMP
+	return __atomic_load_n(&semdActive, __ATOMIC_RELAXED);
+#else
+	return semdPool.po_used;
+#endif
 }
 
 
+/* Empty the ASL, and forget the direct-indexed arrays */
 void initSemd(void){ 
-	semd_h->s_next = NULL;		 /*DUMMY NODE. s_next field points to first ASL entry */
+#ifndef ASL_SORTED
+	int i;
+
+	for (i = 0; i < ASLHASHSIZE; i++)
+		semdHash[i] = NULL;
+#else
+	semdCount = 0;
+#endif
+	directCount = 0;
+	directUsed = 0;
+	directLo = NULL;
+	directHi = NULL;
+}
+
+
+#ifndef ASL_SORTED
+
+/**
+* @brief Look a semaphore up in the ASL.
+*
+* @param semAdd The address of a semaphore.
+*
+* @return The descriptor of semAdd, or NULL if semAdd is not active.
+*/
+HIDDEN semd_t *findSemd(int *semAdd){
+	semd_t *aux = semdHash[ASLHASH(semAdd)];
+
+	STATINC(st_aslLookups);
+	while(aux != NULL && aux->s_semAdd != semAdd){
+		STATINC(st_aslVisits);
+		aux = aux->s_next;
+	}
+	if(aux == NULL)
+		STATINC(st_aslMisses);
+	else
+		STATINC(st_aslVisits);
+	return aux;
+}
+
+
+/**
+* Add the descriptor s, whose s_semAdd is set, to the ASL.
+*
+* @param s A semaphore descriptor that is not on the ASL.
+* @retval FALSE Always: the hash table cannot fill up.
+*/
+HIDDEN int linkSemd(semd_t *s){
+	semd_t **bucket = &semdHash[ASLHASH(s->s_semAdd)];
+
+	s->s_next = *bucket;
+	*bucket = s;
+	return FALSE;
+}
+
+
+/**
+* Remove the descriptor s from the ASL.
+*
+* @param s A semaphore descriptor on the ASL.
+*/
+HIDDEN void unlinkSemd(semd_t *s){
+	semd_t **link = &semdHash[ASLHASH(s->s_semAdd)];
+
+	while(*link != s){
+		STATINC(st_aslVisits);
+		link = &((*link)->s_next);
+	}
+	*link = s->s_next;
+}
+
+#else
+
+/**
+* Bisect semdKey for semAdd.
+*
+* @param semAdd The address of a semaphore.
+* @return The index of the first active address not below semAdd.
+*/
+HIDDEN int searchSemd(int *semAdd){
+	int lo = 0, hi = semdCount;
+
+	while(lo < hi){
+		int mid = (lo + hi) >> 1;
+		STATINC(st_aslVisits);
+		if(semdKey[mid] < semAdd)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+
+/**
+* @brief Look a semaphore up in the ASL.
+*
+* @param semAdd The address of a semaphore.
+*
+* @return The descriptor of semAdd, or NULL if semAdd is not active.
+*/
+HIDDEN semd_t *findSemd(int *semAdd){
+	int i;
+
+	STATINC(st_aslLookups);
+	i = searchSemd(semAdd);
+	if(i < semdCount && semdKey[i] == semAdd)
+		return semdVal[i];
+	STATINC(st_aslMisses);
+	return NULL;
+}
+
+
+/**
+* Add the descriptor s, whose s_semAdd is set, to the ASL at its sorted position.
+*
+* @param s A semaphore descriptor that is not on the ASL.
+* @retval TRUE The array is full.
+* @retval FALSE s has been added.
+*/
+HIDDEN int linkSemd(semd_t *s){
+	int i, pos;
+
+	if(semdCount == MAXPROC)
+		return TRUE;
+	pos = searchSemd(s->s_semAdd);
+	for(i = semdCount; i > pos; i--){	/* open a gap at pos */
+		semdKey[i] = semdKey[i-1];
+		semdVal[i] = semdVal[i-1];
+	}
+	semdKey[pos] = s->s_semAdd;
+	semdVal[pos] = s;
+	semdCount++;
+	return FALSE;
+}
+
+
+/**
+* Remove the n active descriptors starting at index pos from the array.
+*
+* @param pos The index of the first entry to drop.
+* @param n The number of entries to drop.
+*/
+HIDDEN void dropSemd(int pos, int n){
+	int i;
+
+	semdCount -= n;
+	for(i = pos; i < semdCount; i++){
+		semdKey[i] = semdKey[i+n];
+		semdVal[i] = semdVal[i+n];
+	}
+}
+
+
+/**
+* Remove the descriptor s from the ASL.
+*
+* @param s A semaphore descriptor on the ASL.
+*/
+HIDDEN void unlinkSemd(semd_t *s){
+	dropSemd(searchSemd(s->s_semAdd), 1);
+}
+
+#endif
+
+
+/**
+* Return the descriptor of a direct-indexed semaphore.
+*
+* @param semAdd The address of a semaphore.
+* @return The descriptor bound to semAdd by registerSemds(), active or
+* 	   not, or NULL if semAdd is in no registered array.
+*/
+HIDDEN semd_t *directSemd(int *semAdd){
+	int i;
+
+	if(semAdd < directLo || semAdd >= directHi)
+		return NULL;
+	for(i = 0; i < directCount; i++)
+		if(semAdd >= directRange[i].dr_lo && semAdd < directRange[i].dr_hi){
+			STATINC(st_aslDirect);
+			return &directRange[i].dr_semd[semAdd - directRange[i].dr_lo];
+		}
+	return NULL;
+}
+
+
+/**
+* Look a semaphore up, in its direct-indexed array or in the ASL.
+*
+* @param semAdd The address of a semaphore.
+* @return The descriptor of semAdd, or NULL if semAdd is not active.
+*/
+HIDDEN semd_t *activeSemd(int *semAdd){
+	semd_t *s = directSemd(semAdd);
+
+	if(s == NULL)
+		return findSemd(semAdd);
+	return (s->s_count > 0) ? s : NULL;
+}
+
+
+/**
+* @brief Make an array of semaphores direct-indexed.
+*
+* Bind each of the n semaphores starting at base, e.g. the device
+* semaphores and the pseudo-clock, to a descriptor of its own set aside
+* at boot. Blocking on them, waking them and checking their queues then
+* reach the descriptor by the semaphore's offset in the array, in
+* constant time whatever the number of active semaphores, and never take
+* descriptors from the semdFree list. Up to DIRECTRANGES arrays, with
+* DIRECTSEMDS semaphores in all, can be registered until the next
+* initASL(). No semaphore of the array may be active when it is
+* registered; in the multicore build, register the arrays at boot,
+* before the other cores start.
+*
+* @param base The address of the first semaphore of the array.
+* @param n The number of semaphores in the array.
+*
+* @retval TRUE The array overlaps an active semaphore or a registered
+* 	   array, or there is no room left for it.
+* @retval FALSE The array has been registered.
+*/
+int registerSemds(int *base, int n){
+	int i;
+	semd_t *s;
+
+	if(n <= 0 || directCount == DIRECTRANGES || directUsed + n > DIRECTSEMDS)
+		return TRUE;
+	for(i = 0; i < directCount; i++)
+		if(base < directRange[i].dr_hi && base + n > directRange[i].dr_lo)
+			return TRUE;
+	for(i = 0; i < n; i++){
+		LOCKSEMD(base + i);
+		s = findSemd(base + i);
+		UNLOCKSEMD(base + i);
+		if(s != NULL)
+			return TRUE;
+	}
+
+	for(i = 0; i < n; i++){
+		s = &directTable[directUsed + i];
+		s->s_next = NULL;
+		s->s_semAdd = base + i;
+		s->s_procQ = mkEmptyProcQ();
+		s->s_count = 0;
+		s->s_prio = FALSE;
+		s->s_seq = 0;
+		s->s_timed = 0;
+		s->s_gen++;	/* disown ProcBlks left from before initASL() */
+	}
+	directRange[directCount].dr_lo = base;
+	directRange[directCount].dr_hi = base + n;
+	directRange[directCount].dr_semd = &directTable[directUsed];
+	directUsed += n;
+	if(directLo == NULL || base < directLo)
+		directLo = base;
+	if(directHi == NULL || base + n > directHi)
+		directHi = base + n;
+	directCount++;	/* last, so that lookups only see a complete entry */
+	return FALSE;
+}
+
+
+/**
+* Take a descriptor off the semdFree list, and record the peak of
+* semdUsedCount(). Under KAYA_SMP the count is kept in semdActive, so
+* that the peak is taken from an atomic update rather than from the pool,
+* whose counters only semdPoolLock guards.
+*
+* @return A semaphore descriptor, or NULL if none is free.
+*/
+HIDDEN semd_t *allocSemd(void){
+	semd_t *s;
+
+#ifdef KAYA_SMP
+	int n;
+
+	if((s = popLfStack(&semdShared)) == NULL){
+		spinLock(&semdPoolLock);
+		s = allocPool(&semdPool);
+		spinUnlock(&semdPoolLock);
+	}
+	if(s != NULL){
+		n = __atomic_add_fetch(&semdActive, 1, __ATOMIC_RELAXED);
+		STATMAX(st_semdPeak, n);
+		(void) n;	/* unused without KAYA_STATS */
+	}
+#else
+	if((s = allocPool(&semdPool)) != NULL)
+		STATMAX(st_semdPeak, semdPool.po_used);
+#endif
+	return s;
+}
+
+
+/**
+* Return the descriptor s to the semdFree list.
+*
+* @param s A semaphore descriptor no longer on the ASL.
+*/
+HIDDEN void freeSemd(semd_t *s){
+#ifdef KAYA_SMP
+	__atomic_sub_fetch(&semdActive, 1, __ATOMIC_RELAXED);	/* before s can be popped */
+	pushLfStack(&semdShared, s);
+#else
+	freePool(&semdPool, s);
+#endif
+}
+
+
+/**
+* Deactivate the descriptor s, whose queue has been emptied: remove it
+* from the ASL and free it, unless it is direct-indexed.
+*
+* @param s A semaphore descriptor with no waiters.
+*/
+HIDDEN void releaseSemd(semd_t *s){
+	if(!ISDIRECT(s)){
+		unlinkSemd(s);
+		freeSemd(s);
+	}
+}
+
+
+/*
+* Priority-ordered semaphore queues. A descriptor activated by
+* insertBlockedPrio() keeps its waiters in a pairing heap ordered by
+* effective priority (p_eprio, 0 being the highest) and then by arrival
+* (p_hseq), instead of a FIFO ProcQ. The heap reuses the queue links: p_next
+* is the next sibling, p_prev the previous sibling or, for a first child,
+* the parent, and p_hchild the first child. The root's p_prev points to
+* itself, so that a waiter never has a NULL p_prev.
+*/
+
+#define HEAPBEFORE(a, b) ((a)->p_eprio < (b)->p_eprio || \
+	((a)->p_eprio == (b)->p_eprio && (int) ((a)->p_hseq - (b)->p_hseq) < 0))
+
+
+/**
+* Meld two heaps, making the root that comes second the first child of the other.
+*
+* @param a The root of a heap.
+* @param b The root of another heap.
+* @return The root of the melded heap; its p_next and p_prev are not set.
+*/
+HIDDEN pcb_t *linkHeap(pcb_t *a, pcb_t *b){
+	pcb_t *t;
+
+	if(HEAPBEFORE(b, a)){
+		t = a;
+		a = b;
+		b = t;
+	}
+	SETPCBLINK(b, p_next, PCBLINK(a, p_hchild));
+	if(PCBLINK(a, p_hchild) != NULL)
+		SETPCBLINK(PCBLINK(a, p_hchild), p_prev, b);
+	SETPCBLINK(b, p_prev, a);
+	SETPCBLINK(a, p_hchild, b);
+	return a;
+}
+
+
+/**
+* Meld a list of sibling heaps into one, in the two passes of a pairing heap.
+*
+* @param first The first of a non-empty list of heaps linked through p_next.
+* @return The root of the melded heap.
+*/
+HIDDEN pcb_t *mergeHeap(pcb_t *first){
+	pcb_t *a, *b, *pairs = NULL;
+
+	while(first != NULL){		/* meld pairs left to right, stacking them */
+		a = first;
+		b = PCBLINK(a, p_next);
+		first = (b != NULL) ? PCBLINK(b, p_next) : NULL;
+		if(b != NULL)
+			a = linkHeap(a, b);
+		SETPCBLINK(a, p_next, pairs);
+		pairs = a;
+	}
+	a = pairs;			/* then meld the stack into one */
+	pairs = PCBLINK(pairs, p_next);
+	while(pairs != NULL){
+		b = PCBLINK(pairs, p_next);
+		a = linkHeap(a, pairs);
+		pairs = b;
+	}
+	SETPCBLINK(a, p_next, NULL);
+	SETPCBLINK(a, p_prev, a);
+	return a;
+}
+
+
+/**
+* Make a heap with the single ProcBlk p the root of the heap of s.
+*
+* @param s A priority-ordered semaphore descriptor.
+* @param p The root of a heap detached from any other.
+*/
+HIDDEN void meldSemd(semd_t *s, pcb_t *p){
+	if(s->s_procQ != NULL)
+		p = linkHeap(s->s_procQ, p);
+	SETPCBLINK(p, p_next, NULL);
+	SETPCBLINK(p, p_prev, p);
+	s->s_procQ = p;
+}
+
+
+/**
+* Detach p, with its subtree, from the heap of s; p must not be the root.
+*
+* @param p A ProcBlk in a heap, not its root.
+*/
+HIDDEN void cutHeap(pcb_t *p){
+	pcb_t *prev = PCBLINK(p, p_prev), *next = PCBLINK(p, p_next);
+
+	if(PCBLINK(prev, p_hchild) == p)	/* p is a first child: prev is its parent */
+		SETPCBLINK(prev, p_hchild, next);
+	else
+		SETPCBLINK(prev, p_next, next);
+	if(next != NULL)
+		SETPCBLINK(next, p_prev, prev);
+}
+
+
+/**
+* Remove p from the heap of s, in O(log n) amortized time.
+*
+* @param s A priority-ordered semaphore descriptor.
+* @param p A ProcBlk in the heap of s.
+*/
+HIDDEN void outHeap(semd_t *s, pcb_t *p){
+	pcb_t *sub = PCBLINK(p, p_hchild);
+
+	if(p == s->s_procQ)
+		s->s_procQ = NULL;
+	else
+		cutHeap(p);
+	if(sub != NULL)
+		meldSemd(s, mergeHeap(sub));
+	SETPCBLINK(p, p_next, NULL);
+	SETPCBLINK(p, p_prev, NULL);
+	SETPCBLINK(p, p_hchild, NULL);
+}
+
+
+/**
+* Append p to the waiters of s, in FIFO or priority order.
+*
+* @param s A semaphore descriptor.
+* @param p A pointer to a ProcBlk on no queue.
+*/
+HIDDEN void enqueueSemd(semd_t *s, pcb_t *p){
+	if(s->s_prio){
+		p->p_hseq = s->s_seq++;
+		SETPCBLINK(p, p_hchild, NULL);
+		meldSemd(s, p);
+	}
+	else
+		insertProcQ(&(s->s_procQ), p);
+	s->s_count++;
+}
+
+
+/**
+* Remove and return the waiter of s to be woken first.
+*
+* @param s A semaphore descriptor with at least one waiter.
+* @return The head of the FIFO queue or the root of the heap.
+*/
+HIDDEN pcb_t *dequeueSemd(semd_t *s){
+	pcb_t *p = s->s_procQ;
+
+	if(s->s_prio)
+		outHeap(s, p);
+	else
+		p = removeProcQ(&(s->s_procQ));
+	s->s_count--;
+	return p;
+}
+
+
+/**
+* Remove p from the waiters of s.
+*
+* @param s A semaphore descriptor.
+* @param p A pointer to a ProcBlk waiting on s.
+*/
+HIDDEN void outSemd(semd_t *s, pcb_t *p){
+	if(s->s_prio)
+		outHeap(s, p);
+	else
+		outProcQ(&(s->s_procQ), p);
+	s->s_count--;
+}
+
+
+/**
+* Return the waiter of s to be woken first, without removing it.
+*
+* @param s A semaphore descriptor.
+* @return The head of the FIFO queue or the root of the heap, or NULL.
+*/
+HIDDEN pcb_t *headSemd(semd_t *s){
+	if(s->s_prio)
+		return s->s_procQ;
+	return headProcQ(s->s_procQ);
+}
+
+
+/**
+* Cancel the timeout, if any, of p, which has just left the queue of s.
+*
+* @param s The semaphore descriptor p was blocked on.
+* @param p A pointer to a ProcBlk.
+*/
+HIDDEN void cancelTimeout(semd_t *s, pcb_t *p){
+	if(p->p_twait){
+		outWheel(p);
+		p->p_twait = FALSE;
+		s->s_timed--;
+	}
+}
+
+
+/**
+* @brief Move the whole process queue of a descriptor and free the descriptor.
+*
+* Constant time whatever the queue length: instead of clearing p_semd in
+* every waiter, s_gen is bumped, which invalidates all their back-pointers
+* at once (see blockedOn()). Only if some waiters have a timeout armed is
+* the queue walked, to cancel them. A priority-ordered queue is instead
+* turned into a ProcQ, in priority order, in O(n log n) time. The caller must already have removed s from
+* the ASL index; a direct-indexed descriptor is kept, idle, instead. The
+* waiters are appended to a queue of the caller's with concatProcQ(), so
+* that their tail records the caller's tail pointer, not s's or a local.
+*
+* @param s A semaphore descriptor no longer on the ASL, or a direct one.
+* @param tp The address of a pointer to the tail of a Process Queue.
+*/
+HIDDEN void drainSemd(semd_t *s, pcb_t **tp){
+	pcb_t *q = s->s_procQ, *p = q;
+
+	TRACE(TR_UNBLOCKALL, NULL, s->s_semAdd);
+	if(s->s_prio){		/* the heap becomes a ProcQ in priority order */
+		q = mkEmptyProcQ();
+		while((p = s->s_procQ) != NULL){
+			outHeap(s, p);
+			insertProcQ(&q, p);
+		}
+		p = q;
+	}
+	while(s->s_timed > 0){	/* only walk the queue if some waiter has a timeout */
+		p = PCBLINK(p, p_next);
+		cancelTimeout(s, p);
+	}
+	s->s_procQ = mkEmptyProcQ();
+	concatProcQ(tp, &q);
+	s->s_count = 0;
+	s->s_gen++;
+	if(!ISDIRECT(s))
+		freeSemd(s);
+}
+
+
+/**
+* Return the descriptor p is blocked on, if any.
+*
+* p->p_semd is stale once its queue has been detached by drainSemd();
+* it is only trusted while p->p_semgen still matches the descriptor.
+*
+* @param p A pointer to a ProcBlk.
+* @return The descriptor of the semaphore p is blocked on, or NULL.
+*/
+HIDDEN semd_t *blockedOn(pcb_t *p){
+	semd_t *semd = p->p_semd;
+
+	if(semd != NULL && semd->s_gen == p->p_semgen)
+		return semd;
+	return NULL;
+}
+
+
+/**
+* Block p on semAdd, activating a descriptor whose queue is ordered by
+* priority if prio is TRUE, in FIFO order otherwise; see insertBlocked().
+* The caller holds the lock of semAdd.
+*/
+HIDDEN int blockLocked(int *semAdd, pcb_t *p, int prio){
+	semd_t *semd = NULL;
+
+	if((semd = directSemd(semAdd)) != NULL){
+		if(semd->s_count == 0){		/* activate it in place */
+			semd->s_prio = prio;
+			semd->s_seq = 0;
+		}
+	}
+	else if((semd = findSemd(semAdd)) == NULL){
+		/* if the semaphore is not active, activate a new descriptor ... */
+		if((semd = allocSemd()) == NULL){  /*unless we are out sem descriptors */
+			STATINC(st_aslInsertFails);
+			return TRUE;
+		}
+		semd->s_semAdd = semAdd;
+		if(linkSemd(semd)){	/* ... or out of room in the ASL */
+			freeSemd(semd);
+			STATINC(st_aslInsertFails);
+			return TRUE;
+		}
+		semd->s_procQ = mkEmptyProcQ();
+		semd->s_count = 0;
+		semd->s_timed = 0;
+		semd->s_prio = prio;
+		semd->s_seq = 0;
+	}
+	TRACE(TR_BLOCK, p, semAdd);
+	enqueueSemd(semd, p);
+	STATINC(st_aslInserts);
+	STATMAX(st_semQueuePeak, semd->s_count);
+	p->p_semAdd = semAdd;
+	p->p_semd = semd;
+	p->p_semgen = semd->s_gen;
+	return FALSE;
+}
+
+
+/* Lock semAdd and block p on it; see blockLocked() */
+HIDDEN int blockSemd(int *semAdd, pcb_t *p, int prio){
+	int full;
+
+	LOCKSEMD(semAdd);
+	full = blockLocked(semAdd, p, prio);
+	UNLOCKSEMD(semAdd);
+	return full;
 }
 
 
@@ -65,41 +878,87 @@ void initSemd(void){
 * @retval FALSE The ProcBlk has been successfully inserted in a queue.
 */
 int insertBlocked(int *semAdd, pcb_t *p){
-	semd_t *current = semd_h->s_next;
-	semd_t *prev = semd_h;
+	return blockSemd(semAdd, p, FALSE);
+}
 
-	/* scan the ASL until the end, or until an element has a bigger semAdd*/
-	while(current != NULL && current->s_semAdd < semAdd){
-		current = current->s_next;
-		prev = prev->s_next;
-	}
 
-	/* if the correct ASL entry exists, it must be *current update the queue */
-	if(current != NULL && current->s_semAdd == semAdd){
-		insertProcQ(&(current->s_procQ), p);
-		p->p_semAdd = semAdd;
-		return FALSE;
-	}
-	/* if not, insert the element before the current one ... */
-	else{
-		if(semdFree_h == NULL){	  /*unless we are out sem descriptors */
-			return TRUE;
-		}
-		else{
-			semd_t *newSemd = NULL;
-			newSemd = semdFree_h;
-			semdFree_h = newSemd->s_next;
-			
-			prev->s_next = newSemd;
-			newSemd->s_next = current;
-	
-			newSemd->s_semAdd = semAdd;
-			newSemd->s_procQ = mkEmptyProcQ();
-			insertProcQ(&(newSemd->s_procQ), p);
-			p->p_semAdd = semAdd;
-			return FALSE;
-		}
+/**
+* @brief Insert a ProcBlk in the priority-ordered queue of a semaphore.
+*
+* Like insertBlocked(), but if the semaphore is not active its new
+* descriptor keeps the waiters in a heap ordered by effective priority,
+* p_eprio, and then by arrival: removeBlocked() and headBlocked() then
+* return the waiter with the highest priority (the lowest p_eprio), and
+* removeAllBlocked() moves the waiters in that order. Insertion and
+* removal take O(log n) amortized time, headBlocked() constant time. Any
+* process blocking on the semaphore while it stays active, with either
+* function, joins the same heap.
+*
+* @param semAdd The address of a semaphore.
+* @param p A pointer to a ProcBlk.
+*
+* @retval TRUE A new semaphore descriptor needs to be allocated, but none are avalaible.
+* @retval FALSE The ProcBlk has been successfully inserted in a queue.
+*/
+int insertBlockedPrio(int *semAdd, pcb_t *p){
+	return blockSemd(semAdd, p, TRUE);
+}
+
+
+/**
+* @brief Insert a ProcBlk in the ProcQ of a semaphore, with a timeout.
+*
+* Like insertBlocked(), but also arm a timer on p in the timing wheel w:
+* if p is still blocked when the timer expires, tickWheel() removes it from
+* the semaphore's queue as outBlocked() would, and returns it with the
+* other expired ProcBlks. Waking p first, with removeBlocked(), outBlocked(),
+* removeAllBlocked() or removeBlockedRange(), cancels the timer. In the
+* multicore build the wheel is not locked: the semaphore must then only be
+* used by the core that ticks w.
+*
+* @param semAdd The address of a semaphore.
+* @param p A pointer to a ProcBlk with no timer armed.
+* @param w A pointer to a timing wheel.
+* @param ticks The timeout, in ticks of w.
+*
+* @retval TRUE A new semaphore descriptor needs to be allocated, but none are avalaible.
+* @retval FALSE The ProcBlk has been successfully inserted in a queue.
+*/
+int insertBlockedTimed(int *semAdd, pcb_t *p, wheel_t *w, unsigned int ticks){
+	LOCKSEMD(semAdd);	/* p must not be woken before its timer is armed */
+	if(blockLocked(semAdd, p, FALSE)){
+		UNLOCKSEMD(semAdd);
+		return TRUE;
 	}
+	insertWheel(w, p, ticks);
+	p->p_twait = TRUE;
+	p->p_semd->s_timed++;
+	UNLOCKSEMD(semAdd);
+	return FALSE;
+}
+
+
+/**
+* Remove the first ProcBlk blocked on semAdd; see removeBlocked(). The
+* caller holds the lock of semAdd.
+*/
+HIDDEN pcb_t *wakeLocked(int *semAdd){
+
+	semd_t *current = NULL;
+	pcb_t *removed = NULL;
+
+	current = activeSemd(semAdd);
+	if(current  == NULL)
+		return NULL;
+	STATINC(st_aslRemoves);
+	removed = dequeueSemd(current);
+	TRACE(TR_UNBLOCK, removed, semAdd);
+	removed->p_semd = NULL;
+	cancelTimeout(current, removed);
+	/*if we removed the last procBlk, the semaphore must be deactivated*/
+	if(current->s_count == 0)
+		releaseSemd(current);
+	return removed;
 }
 
 
@@ -120,29 +979,12 @@ int insertBlocked(int *semAdd, pcb_t *p){
 */
 pcb_t *removeBlocked(int *semAdd){
 
-	semd_t* current = semd_h->s_next;
-	semd_t* prev = semd_h;
 	pcb_t *removed = NULL;
 
-	/* scan the list until the end, or until we find our entry */
-	while(current != NULL && current->s_semAdd != semAdd){
-		current = current->s_next;
-		prev = prev->s_next;
-	}
-
-	/*current is either NULL, or has the correct semAdd*/
-	if(current  == NULL)
-		return NULL;
-	else{
-		removed = removeProcQ(&(current->s_procQ));
-	/*if we removed the last procBlk, the semaphore must be deactivated*/
-		if(emptyProcQ(current->s_procQ)){
-			prev->s_next = current->s_next;
-			current->s_next = semdFree_h;
-			semdFree_h = current;
-		}
-		return removed;
-	}
+	LOCKSEMD(semAdd);
+	removed = wakeLocked(semAdd);
+	UNLOCKSEMD(semAdd);
+	return removed;
 }
 
 
@@ -153,7 +995,10 @@ pcb_t *removeBlocked(int *semAdd){
 * with p’s semaphore (p->p_semAdd) on the ASL. If ProcBlk
 * pointed to by p does not appear in the process queue associated with
 * p’s semaphore, which is an error condition, return NULL; otherwise,
-* return p.
+* return p. If the process queue becomes empty, the descriptor is
+* removed from the ASL and returned to the semdFree list.
+*
+* The descriptor is reached through p->p_semd, so no ASL lookup is needed.
 *
 * @param p A pointer to the ProcBlk to be removed.
 *
@@ -161,15 +1006,27 @@ pcb_t *removeBlocked(int *semAdd){
 * @return NULL if an error occurred.
 */
 pcb_t *outBlocked(pcb_t *p){
-	if (!p)
+	semd_t *semd = NULL;
+
+	if (!p) {
+		STATINC(st_aslOutFails);
 		return NULL;
-	semd_t *aux = semd_h; /* points to head of ASL */
-	while (aux) {
-		if (aux->s_semAdd == p->p_semAdd)
-			return outProcQ(&(aux->s_procQ), p); /* i.e. either p or NULL */
-		aux = aux->s_next;							
 	}
-	return NULL;
+	LOCKSEMD(p->p_semAdd);	/* p->p_semd, if still valid, is in this bucket */
+	if ((semd = blockedOn(p)) == NULL) {	/* p is not blocked */
+		UNLOCKSEMD(p->p_semAdd);
+		STATINC(st_aslOutFails);
+		return NULL;
+	}
+	STATINC(st_aslOuts);
+	outSemd(semd, p);
+	TRACE(TR_UNBLOCK, p, p->p_semAdd);
+	p->p_semd = NULL;
+	cancelTimeout(semd, p);
+	if (semd->s_count == 0)
+		releaseSemd(semd);
+	UNLOCKSEMD(p->p_semAdd);
+	return p;
 }
 
 
@@ -187,12 +1044,324 @@ pcb_t *outBlocked(pcb_t *p){
 * @return NULL The ProcQ associated with *semAdd is empty.
 */
 pcb_t *headBlocked(int *semAdd){
-	semd_t *aux = semd_h; /* points to head of ASL */
-	while (aux) {
-		if (aux->s_semAdd == semAdd)
-			return headProcQ(aux->s_procQ); /* i.e. either procQHead or NULL */
-		aux = aux->s_next;				
+	semd_t *aux = NULL;
+	pcb_t *head = NULL;
+
+	STATINC(st_aslHeads);
+	LOCKSEMD(semAdd);
+	aux = activeSemd(semAdd);
+	if (aux != NULL)
+		head = headSemd(aux); /* i.e. either procQHead or NULL */
+	UNLOCKSEMD(semAdd);
+	return head;
+}
+
+
+/**
+* @brief Remove every ProcBlk blocked on a specified semaphore.
+*
+* Detach the whole process queue associated with the semaphore semAdd,
+* remove the descriptor from the ASL and return it to the semdFree list.
+* The queue is appended, in FIFO order, to the process queue whose
+* tail-pointer is pointed to by tp, such as a ready queue, in one step.
+* Constant time, whatever the number of waiters, unless some of them have
+* a timeout armed (see insertBlockedTimed()).
+*
+* @param semAdd The address of a semaphore.
+* @param tp The address of a pointer to the tail of a Process Queue.
+*
+* @return The number of ProcBlks moved to *tp; 0 if semAdd is not found
+* 	   on the ASL.
+*/
+int removeAllBlocked(int *semAdd, pcb_t **tp){
+	semd_t *semd = NULL;
+	int count = 0;
+
+	LOCKSEMD(semAdd);
+	if((semd = activeSemd(semAdd)) != NULL){
+		STATINC(st_aslRemoveAlls);
+		if(!ISDIRECT(semd))
+			unlinkSemd(semd);
+		count = semd->s_count;
+		drainSemd(semd, tp);
 	}
-	return NULL;
+	UNLOCKSEMD(semAdd);
+	return count;
+}
+
+
+/**
+* Drain the direct semaphores of the range [lo, hi) onto *tp.
+*
+* @param lo The address of the first semaphore of the range.
+* @param hi The address just past the last semaphore of the range.
+* @param tp The address of a pointer to the tail of a Process Queue.
+* @return The number of ProcBlks moved to *tp.
+*/
+HIDDEN int drainDirectRange(int *lo, int *hi, pcb_t **tp){
+	int i, count = 0;
+	int *semAdd;
+	semd_t *semd;
+
+	for(i = 0; i < directCount; i++){
+		semAdd = (lo > directRange[i].dr_lo) ? lo : directRange[i].dr_lo;
+		for(; semAdd < hi && semAdd < directRange[i].dr_hi; semAdd++){
+			LOCKSEMD(semAdd);
+			if((semd = activeSemd(semAdd)) != NULL){
+				count += semd->s_count;
+				drainSemd(semd, tp);
+			}
+			UNLOCKSEMD(semAdd);
+		}
+	}
+	return count;
 }
 
+
+/**
+* @brief Wake every process blocked on a range of semaphores.
+*
+* Remove all the ProcBlks blocked on any semaphore whose address lies in
+* [lo, hi) and append them to the process queue whose tail-pointer is
+* pointed to by tp, deactivating the emptied descriptors. Each queue is
+* moved whole, in FIFO order, in constant time. With ASL_SORTED the active
+* semaphores in the range are adjacent in the array, and are found with a
+* single bisection. The hash table instead looks up each word address of a
+* range no wider than the table, and walks every bucket for a wider one,
+* so a lookup never costs more than a pass over the table; in the latter
+* case the semaphores are emptied in no particular order.
+*
+* @param lo The address of the first semaphore of the range.
+* @param hi The address just past the last semaphore of the range.
+* @param tp The address of a pointer to the tail of a Process Queue.
+*
+* @return The number of ProcBlks moved to *tp.
+*/
+int removeBlockedRange(int *lo, int *hi, pcb_t **tp){
+	int count = 0;
+	semd_t *semd = NULL;
+#ifndef ASL_SORTED
+	int *semAdd, i;
+	semd_t **link;
+
+	if(hi - lo <= ASLHASHSIZE){
+		for(semAdd = lo; semAdd < hi; semAdd++){
+			LOCKSEMD(semAdd);
+			if((semd = activeSemd(semAdd)) != NULL){
+				count += semd->s_count;
+				if(!ISDIRECT(semd))
+					unlinkSemd(semd);
+				drainSemd(semd, tp);
+			}
+			UNLOCKSEMD(semAdd);
+		}
+		return count;
+	}
+	for(i = 0; i < ASLHASHSIZE; i++){
+#ifdef KAYA_SMP
+		spinLock(&semdLock[i].bl_lock);
+#endif
+		link = &semdHash[i];
+		while((semd = *link) != NULL){
+			STATINC(st_aslVisits);
+			if(semd->s_semAdd >= lo && semd->s_semAdd < hi){
+				*link = semd->s_next;
+				count += semd->s_count;
+				drainSemd(semd, tp);
+			}
+			else
+				link = &(semd->s_next);
+		}
+#ifdef KAYA_SMP
+		spinUnlock(&semdLock[i].bl_lock);
+#endif
+	}
+#else
+	int i, first = searchSemd(lo), last = searchSemd(hi);
+
+	for(i = first; i < last; i++){
+		semd = semdVal[i];
+		count += semd->s_count;
+		drainSemd(semd, tp);
+	}
+	dropSemd(first, last - first);	/* one shift for the whole run */
+#endif
+	return count + drainDirectRange(lo, hi, tp);	/* not in the index */
+}
+
+
+/**
+* Give p the effective priority eprio, moving it within the heap it waits in.
+*
+* @param p A pointer to a ProcBlk.
+* @param eprio The new effective priority of p.
+*/
+HIDDEN void reprioritize(pcb_t *p, int eprio){
+	semd_t *semd = NULL;
+
+	LOCKSEMD(p->p_semAdd);
+	semd = blockedOn(p);
+	if(semd == NULL || !semd->s_prio || eprio == p->p_eprio)
+		p->p_eprio = eprio;
+	else if(eprio < p->p_eprio){	/* raised: cut and meld with the root */
+		p->p_eprio = eprio;
+		if(p != semd->s_procQ){
+			cutHeap(p);
+			meldSemd(semd, p);
+		}
+	}
+	else{				/* lowered: remove and insert again */
+		outHeap(semd, p);
+		p->p_eprio = eprio;
+		SETPCBLINK(p, p_hchild, NULL);
+		meldSemd(semd, p);
+	}
+	UNLOCKSEMD(p->p_semAdd);
+}
+
+
+/**
+* @brief Set the base priority of a process.
+*
+* Set both the base and the effective priority of the ProcBlk pointed to
+* by p to prio, 0 being the highest. If p is waiting in a
+* priority-ordered queue, it is moved to its new place.
+*
+* @param p A pointer to a ProcBlk.
+* @param prio The new priority of p.
+*/
+void setPrio(pcb_t *p, int prio){
+	p->p_prio = prio;
+	reprioritize(p, prio);
+}
+
+
+/**
+* @brief Lend a process the priority of the processes waiting for it.
+*
+* Priority inheritance: raise the effective priority of holder, the
+* process holding the semaphore semAdd, to that of the highest priority
+* process blocked on semAdd, if the latter is higher. If holder is
+* itself waiting in a priority-ordered queue, it moves up accordingly.
+* The kernel calls this whenever a process blocks on a semaphore held by
+* another, and restorePrio() when the holder releases it.
+*
+* @param holder A pointer to the ProcBlk holding semAdd.
+* @param semAdd The address of a semaphore.
+* @return The effective priority of holder.
+*/
+int boostPrio(pcb_t *holder, int *semAdd){
+	semd_t *semd = NULL;
+	pcb_t *head = NULL;
+	int eprio = holder->p_eprio;
+
+	LOCKSEMD(semAdd);
+	if((semd = activeSemd(semAdd)) != NULL && (head = headSemd(semd)) != NULL &&
+		head->p_eprio < eprio)
+		eprio = head->p_eprio;
+	UNLOCKSEMD(semAdd);
+	if(eprio < holder->p_eprio)
+		reprioritize(holder, eprio);
+	return eprio;
+}
+
+
+/**
+* @brief Drop the priority a process has inherited.
+*
+* Give the ProcBlk pointed to by p back its base priority, e.g. once it
+* has released the semaphore that boostPrio() boosted it for.
+*
+* @param p A pointer to a ProcBlk.
+*/
+void restorePrio(pcb_t *p){
+	reprioritize(p, p->p_prio);
+}
+
+
+/*
+* P and V. The semaphore's own value tells whether anyone waits on it:
+* it is negative exactly when -value processes are blocked. So P on a
+* positive semaphore and V on a non-negative one only update the value,
+* without touching the ASL. Only when a process must block or be woken
+* is the bucket lock taken and the ASL used. In the multicore build the
+* fast paths update the value with a compare-and-swap, and it only
+* crosses zero downwards, or is raised while negative, under the lock,
+* together with the matching enqueue or dequeue, so a V can never miss
+* a P that is about to block.
+*/
+
+#ifdef KAYA_SMP
+#define SEMLOAD(semAdd) __atomic_load_n((semAdd), __ATOMIC_RELAXED)
+#define SEMCAS(semAdd, old, new) \
+	__atomic_compare_exchange_n((semAdd), &(old), (new), FALSE, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+#define SEMADD(semAdd, d) __atomic_fetch_add((semAdd), (d), __ATOMIC_ACQ_REL)
+#else
+#define SEMLOAD(semAdd) (*(semAdd))
+#define SEMCAS(semAdd, old, new) (*(semAdd) = (new), TRUE)
+#define SEMADD(semAdd, d) ((*(semAdd) += (d)) - (d))
+#endif
+
+
+/**
+* @brief Perform a P on a semaphore.
+*
+* Decrement the semaphore at semAdd on behalf of the process of the
+* ProcBlk pointed to by p. If the value was positive, that is all, and
+* the ASL is not touched; otherwise p is blocked on semAdd, as by
+* insertBlocked(). Processes blocked on a semaphore used through
+* passeren() and verhogen() must only leave it through verhogen(), or
+* else the caller must give back the unit they took, as Kaya does when
+* it terminates a blocked process.
+*
+* @param semAdd The address of a semaphore.
+* @param p A pointer to the ProcBlk of the calling process.
+*
+* @retval TRUE p has been blocked.
+* @retval FALSE p may go on.
+*/
+int passeren(int *semAdd, pcb_t *p){
+	int v = SEMLOAD(semAdd);
+
+	while(v > 0)
+		if(SEMCAS(semAdd, v, v - 1)){
+			STATINC(st_semFast);
+			return FALSE;
+		}
+	LOCKSEMD(semAdd);
+	if(SEMADD(semAdd, -1) > 0){	/* raised since we looked */
+		UNLOCKSEMD(semAdd);
+		return FALSE;
+	}
+	if(blockLocked(semAdd, p, FALSE))
+		PANIC();		/* no descriptor for a process that must wait */
+	UNLOCKSEMD(semAdd);
+	return TRUE;
+}
+
+
+/**
+* @brief Perform a V on a semaphore.
+*
+* Increment the semaphore at semAdd. If its value was negative, remove
+* the first ProcBlk blocked on it, as removeBlocked() would; otherwise
+* nobody waits, and the ASL is not touched.
+*
+* @param semAdd The address of a semaphore.
+* @return A pointer to the ProcBlk woken, or NULL if there was none.
+*/
+pcb_t *verhogen(int *semAdd){
+	int v = SEMLOAD(semAdd);
+	pcb_t *p = NULL;
+
+	while(v >= 0)
+		if(SEMCAS(semAdd, v, v + 1)){
+			STATINC(st_semFast);
+			return NULL;
+		}
+	LOCKSEMD(semAdd);
+	if(SEMADD(semAdd, 1) < 0)
+		p = wakeLocked(semAdd);
+	UNLOCKSEMD(semAdd);
+	return p;
+}
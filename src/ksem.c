@@ -0,0 +1,154 @@
+/**
+* @file ksem.c
+* @brief Function definitions for kernel semaphore objects.
+* @details A ksem_t keeps its value and the tail pointer of its waiters'
+* 				 ProcQ side by side, so P and V work on the object they are
+* 				 given and never look a descriptor up in the ASL, nor take one
+* 				 from semdFree: the descriptors are left to the address-keyed
+* 				 semaphores of insertBlocked(), such as those of the devices.
+* 				 A blocked ProcBlk points back to its ksem_t through p_ksem, so
+* 				 it can also be taken off the queue in constant time. The
+* 				 waiters are served in FIFO order.
+*/
+
+#include "const.h"
+#include "types.h"
+#include "ksem.h"
+#include "trace.h"
+
+
+/**
+* Initialize the semaphore pointed to by ks, with no waiters.
+*
+* @param ks A pointer to the semaphore.
+* @param value Its initial value, not negative.
+*/
+void initKsem(ksem_t *ks, int value){
+
+	ks->ks_value = value;
+	ks->ks_procQ = mkEmptyProcQ();
+	ks->ks_lock = SPINUNLOCKED;
+
+}
+
+
+/**
+* @brief Perform a P on a semaphore.
+*
+* Decrement the value of the semaphore pointed to by ks and, if it was
+* not positive, block the ProcBlk pointed to by p at the tail of its
+* queue.
+*
+* @param ks A pointer to the semaphore.
+* @param p A pointer to the ProcBlk of the calling process, on no queue.
+*
+* @retval TRUE p has been blocked.
+* @retval FALSE p may go on.
+*/
+int passerenKsem(ksem_t *ks, pcb_t *p){
+
+	int blocked = FALSE;
+
+	spinLock(&ks->ks_lock);
+	if(ks->ks_value-- <= 0){
+		TRACE(TR_BLOCK, p, &ks->ks_value);
+		insertProcQ(&ks->ks_procQ, p);
+		p->p_ksem = ks;
+		blocked = TRUE;
+	}
+	spinUnlock(&ks->ks_lock);
+	return blocked;
+
+}
+
+
+/**
+* @brief Perform a V on a semaphore.
+*
+* Increment the value of the semaphore pointed to by ks and, if it was
+* negative, unblock the ProcBlk at the head of its queue.
+*
+* @param ks A pointer to the semaphore.
+* @return A pointer to the ProcBlk unblocked, or NULL if none waited.
+*/
+pcb_t *verhogenKsem(ksem_t *ks){
+
+	pcb_t *p = NULL;
+
+	spinLock(&ks->ks_lock);
+	if(ks->ks_value++ < 0){
+		p = removeProcQ(&ks->ks_procQ);
+		p->p_ksem = NULL;
+		TRACE(TR_UNBLOCK, p, &ks->ks_value);
+	}
+	spinUnlock(&ks->ks_lock);
+	return p;
+
+}
+
+
+/**
+* @brief Unblock every process waiting on a semaphore.
+*
+* Move the whole queue of the semaphore pointed to by ks, in FIFO order,
+* to the tail of the process queue whose tail-pointer is pointed to by
+* tp, such as a ready queue, and give back the units its waiters took,
+* leaving the value at 0. The queue is appended with concatProcQ(); its
+* ProcBlks are visited only to clear p_ksem.
+*
+* @param ks A pointer to the semaphore.
+* @param tp The address of a pointer to the tail of a Process Queue.
+* @return The number of ProcBlks unblocked.
+*/
+int broadcastKsem(ksem_t *ks, pcb_t **tp){
+
+	pcb_t *p;
+	int count = 0;
+
+	spinLock(&ks->ks_lock);
+	if(!emptyProcQ(ks->ks_procQ)){
+		TRACE(TR_UNBLOCKALL, NULL, &ks->ks_value);
+		p = ks->ks_procQ;
+		do{			/* under the lock, for outKsem() */
+			p = PCBLINK(p, p_next);
+			p->p_ksem = NULL;
+		}while(p != ks->ks_procQ);
+		count = -ks->ks_value;
+		ks->ks_value = 0;
+		concatProcQ(tp, &ks->ks_procQ);
+	}
+	spinUnlock(&ks->ks_lock);
+	return count;
+
+}
+
+
+/**
+* @brief Remove a process from the semaphore it is blocked on.
+*
+* Take the ProcBlk pointed to by p off the queue of the ksem_t it is
+* blocked on and give back the unit it took, as a terminated process
+* no longer waits for it.
+*
+* @param p A pointer to a ProcBlk.
+* @return p, or NULL if p is not blocked on a ksem_t.
+*/
+pcb_t *outKsem(pcb_t *p){
+
+	ksem_t *ks = p->p_ksem;
+
+	if(ks == NULL)
+		return NULL;
+	spinLock(&ks->ks_lock);
+	if(p->p_ksem != ks){		/* woken meanwhile */
+		spinUnlock(&ks->ks_lock);
+		return NULL;
+	}
+	outProcQ(&ks->ks_procQ, p);
+	ks->ks_value++;
+	p->p_ksem = NULL;
+	TRACE(TR_UNBLOCK, p, &ks->ks_value);
+	spinUnlock(&ks->ks_lock);
+	return p;
+
+}
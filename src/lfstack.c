@@ -0,0 +1,86 @@
+/**
+* @file lfstack.c
+* @brief Function definitions for the lock-free stack.
+* @details The head of the stack is a single 64 bit word updated with
+* 				 compare-and-swap. With 32 bit addresses the upper half holds a
+* 				 32 bit generation tag. With 64 bit addresses the object address,
+* 				 8 byte aligned and within a 48 bit address space, takes the low
+* 				 45 bits and the tag the upper 19. Objects pushed here must never
+* 				 be unmapped, since a popping core may still read the link of an
+* 				 object that another core has just taken; the slab pools never
+* 				 shrink, so this holds for ProcBlk's and descriptors.
+*/
+
+#include "const.h"
+#include "lfstack.h"
+
+#if defined(__LP64__) || defined(_WIN64)
+#define TAGSHIFT 45
+#define PACK(obj, tag) \
+	((unsigned long long) (unsigned long) (obj) >> 3 | (unsigned long long) (tag) << TAGSHIFT)
+#define UNPACKOBJ(h) ((void *) (unsigned long) (((h) & ((1ULL << TAGSHIFT) - 1)) << 3))
+#else
+#define TAGSHIFT 32
+#define PACK(obj, tag) \
+	((unsigned long long) (unsigned long) (obj) | (unsigned long long) (tag) << TAGSHIFT)
+#define UNPACKOBJ(h) ((void *) (unsigned long) ((h) & 0xFFFFFFFFULL))
+#endif
+
+#define UNPACKTAG(h) ((h) >> TAGSHIFT)
+
+
+/**
+* Initialize an empty stack.
+*
+* @param ls A pointer to the stack.
+*/
+void initLfStack(lfstack_t *ls){
+
+	ls->lf_head = PACK(NULL, 0);
+
+}
+
+
+/**
+* Push an object on the stack. Safe against concurrent pushes and pops.
+*
+* @param ls A pointer to the stack.
+* @param obj A pointer to the object; its first word is overwritten.
+*/
+void pushLfStack(lfstack_t *ls, void *obj){
+
+	unsigned long long old = __atomic_load_n(&ls->lf_head, __ATOMIC_RELAXED);
+	unsigned long long nhead;
+
+	do{
+		__atomic_store_n((void **) obj, UNPACKOBJ(old), __ATOMIC_RELAXED);
+		nhead = PACK(obj, UNPACKTAG(old) + 1);
+	}while(!__atomic_compare_exchange_n(&ls->lf_head, &old, nhead, TRUE,
+					    __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+}
+
+
+/**
+* Pop the top object off the stack. Safe against concurrent pushes and pops.
+*
+* @param ls A pointer to the stack.
+* @return The popped object, or NULL if the stack was empty.
+*/
+void *popLfStack(lfstack_t *ls){
+
+	unsigned long long old = __atomic_load_n(&ls->lf_head, __ATOMIC_ACQUIRE);
+	unsigned long long nhead;
+	void *obj;
+
+	do{
+		obj = UNPACKOBJ(old);
+		if(obj == NULL)
+			return NULL;
+		/* may read a stale link if obj is taken meanwhile: the tag check discards it */
+		nhead = PACK(__atomic_load_n((void **) obj, __ATOMIC_RELAXED), UNPACKTAG(old) + 1);
+	}while(!__atomic_compare_exchange_n(&ls->lf_head, &old, nhead, TRUE,
+					    __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+	return obj;
+
+}
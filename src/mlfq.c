@@ -0,0 +1,216 @@
+/**
+* @file mlfq.c
+* @brief Function definitions for the multi-level feedback ready queue.
+* @details An MLFQ is an array of MLFQLEVELS ordinary ProcQs plus a bitmap of
+* 				 the non-empty ones, so picking the next process is constant time
+* 				 whatever the number of levels and processes. A process is queued
+* 				 at its p_level; running through a whole quantum (chargeMlfq)
+* 				 demotes it, and boostMlfq lifts every queued process back to
+* 				 the top so that CPU-bound processes cannot starve. Nothing is
+* 				 allocated: the levels link the ProcBlks through p_next/p_prev.
+*/
+
+#include "const.h"
+#include "types.h"
+#include "mlfq.h"
+
+
+/* Index of the lowest set bit, by de Bruijn multiplication: uARM has no
+ * count-trailing-zeros instruction */
+HIDDEN const unsigned char debruijn[32] = {
+	0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+	31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+};
+
+#define LOWESTBIT(x) (debruijn[(((x) & -(x)) * 0x077CB531u) >> 27])
+
+
+/**
+* Return the highest priority non-empty level of mq. A level emptied from
+* outside, by terminateSubtree(), still has its bit set: it is cleared
+* here, once, so the cost stays amortized constant.
+*
+* @param mq A pointer to an MLFQ.
+* @return A level, or -1 if the MLFQ is empty.
+*/
+HIDDEN int topLevel(mlfq_t *mq){
+
+	int level;
+
+	while(mq->mq_busy != 0){
+		level = LOWESTBIT(mq->mq_busy);
+		if(!emptyProcQ(mq->mq_level[level]))
+			return level;
+		mq->mq_busy &= ~(1u << level);
+	}
+	return -1;
+
+}
+
+
+/**
+* Initialize an empty multi-level feedback queue.
+*
+* @param mq A pointer to the MLFQ to be initialized.
+*/
+void initMlfq(mlfq_t *mq){
+
+	int i;
+
+	for(i = 0; i < MLFQLEVELS; i++)
+		mq->mq_level[i] = mkEmptyProcQ();
+	mq->mq_busy = 0;
+
+}
+
+
+/**
+* Check if an MLFQ is empty.
+*
+* @param mq A pointer to an MLFQ.
+* @return TRUE if no level holds a ProcBlk, FALSE otherwise.
+*/
+int emptyMlfq(mlfq_t *mq){
+
+	if(topLevel(mq) < 0)
+		return TRUE;
+	else
+		return FALSE;
+
+}
+
+
+/**
+* @brief Insert a ProcBlk in an MLFQ.
+*
+* Insert the ProcBlk pointed to by p at the tail of the level given by
+* its p_level field.
+*
+* @param mq A pointer to an MLFQ.
+* @param p A pointer to the ProcBlk to be inserted.
+*/
+void insertMlfq(mlfq_t *mq, pcb_t *p){
+
+	int level = PCBHOT(p, p_level);
+
+	insertProcQ(&(mq->mq_level[level]), p);
+	mq->mq_busy |= 1u << level;
+
+}
+
+
+/**
+* @brief Return the next ProcBlk to run, without removing it.
+*
+* @param mq A pointer to an MLFQ.
+* @return The head of the highest non-empty level, or NULL if the MLFQ is empty.
+*/
+pcb_t *headMlfq(mlfq_t *mq){
+
+	int level = topLevel(mq);
+
+	if(level < 0)
+		return NULL;
+	return headProcQ(mq->mq_level[level]);
+
+}
+
+
+/**
+* @brief Dequeue the next ProcBlk to run.
+*
+* Remove the head of the highest priority non-empty level.
+*
+* @param mq A pointer to an MLFQ.
+* @return The removed ProcBlk, or NULL if the MLFQ was empty.
+*/
+pcb_t *removeMlfq(mlfq_t *mq){
+
+	int level = topLevel(mq);
+	pcb_t *p = NULL;
+
+	if(level < 0)
+		return NULL;
+	p = removeProcQ(&(mq->mq_level[level]));
+	if(emptyProcQ(mq->mq_level[level]))
+		mq->mq_busy &= ~(1u << level);
+	return p;
+
+}
+
+
+/**
+* @brief Remove a specific ProcBlk from an MLFQ.
+*
+* @param mq A pointer to an MLFQ.
+* @param p A pointer to the ProcBlk to be removed; it is looked for at its p_level.
+* @return p, or NULL if p is not queued.
+*/
+pcb_t *outMlfq(mlfq_t *mq, pcb_t *p){
+
+	int level = PCBHOT(p, p_level);
+
+	if(outProcQ(&(mq->mq_level[level]), p) == NULL)
+		return NULL;
+	if(emptyProcQ(mq->mq_level[level]))
+		mq->mq_busy &= ~(1u << level);
+	return p;
+
+}
+
+
+/**
+* @brief Charge CPU time to a running process.
+*
+* Add ticks to the time p has used at its level. Once p has used up the
+* quantum of its level it is demoted one level (unless already at the
+* lowest) and its count starts over. A process that gives up the CPU
+* before its quantum expires keeps its level.
+*
+* @param p A pointer to the running ProcBlk, which must not be queued.
+* @param ticks The number of ticks p has run for.
+* @retval TRUE p has used up its quantum and should be preempted.
+* @retval FALSE p may keep running.
+*/
+int chargeMlfq(pcb_t *p, int ticks){
+
+	PCBHOT(p, p_ticks) += ticks;
+	if(PCBHOT(p, p_ticks) < MLFQ_QUANTUM(PCBHOT(p, p_level)))
+		return FALSE;
+	if(PCBHOT(p, p_level) < MLFQLEVELS - 1)
+		PCBHOT(p, p_level)++;
+	PCBHOT(p, p_ticks) = 0;
+	return TRUE;
+
+}
+
+
+/**
+* @brief Move every queued process to the highest level.
+*
+* Meant to be called periodically, so that processes demoted while CPU
+* bound get a chance to run again. Each level is moved with a single
+* concatProcQ(); resetting the levels costs one step per moved process.
+*
+* @param mq A pointer to an MLFQ.
+*/
+void boostMlfq(mlfq_t *mq){
+
+	int i;
+	pcb_t *p = NULL;
+
+	for(i = 1; i < MLFQLEVELS; i++){
+		if(emptyProcQ(mq->mq_level[i]))
+			continue;
+		p = mq->mq_level[i];
+		do{
+			PCBHOT(p, p_level) = 0;
+			PCBHOT(p, p_ticks) = 0;
+			p = PCBLINK(p, p_next);
+		}while(p != mq->mq_level[i]);
+		concatProcQ(&(mq->mq_level[0]), &(mq->mq_level[i]));
+		mq->mq_busy |= 1u;
+	}
+	mq->mq_busy &= 1u;
+
+}
@@ -12,9 +12,47 @@
 #include "const.h"
 #include "types.h"
 #include "pcb.h"
+#include "slab.h"
+#include "stats.h"
+#include "lfstack.h"
+#include "spinlock.h"
+#include "trace.h"
+#include "pid.h"
+
+
+HIDDEN pool_t pcbPool; /**< the pcbFree list, and the slabs of ProcBlocks it draws from */
+
+#ifdef PCB_COMPACT
+pcb_t pcbTable[MAXPROC];	/**< every ProcBlock, as links are indices in this table */
+pcbhot_t pcbHot[MAXPROC];	/**< links and scheduling fields of pcbTable[i] */
+#endif
+
+#ifdef KAYA_SMP
+
+/*
+* Multicore allocation. Each core keeps a small private cache of free
+* ProcBlk’s, touched only by that core, in front of a shared lock-free
+* stack; only when both are empty does a core take pcbPoolLock and carve
+* fresh ProcBlk’s out of pcbPool. Caches are refilled and flushed half
+* at a time, so a core alternating allocations and frees stays on its own
+* cache. allocPcb() and freePcb() must not be used concurrently with these.
+*/
+
+/**
+* @brief Per-core cache of free ProcBlk’s.
+*/
+typedef struct pcbcache_t {
+	pcb_t *pc_obj[PCBCACHE];	/* the cached ProcBlk’s */
+	int pc_count;			/* number of entries in use, read unlocked by pcbParked() */
+	char pc_pad[64];		/* keep other cores' caches off this line */
+} pcbcache_t;
 
+HIDDEN pcbcache_t pcbCache[MAXCPU];	/**< pcbCache[cpu] is only used by core cpu */
+HIDDEN lfstack_t pcbShared;		/**< ProcBlk’s freed beyond the caches */
+HIDDEN int pcbStacked;			/**< number of ProcBlk’s on pcbShared, or more */
+HIDDEN spinlock_t pcbPoolLock = SPINUNLOCKED;	/**< serializes access to pcbPool */
 
-HIDDEN pcb_t *pcbFree_h; /**< pointer to the head of a list of free ProcBlocks */
+#endif
 
 /* PCB allocation Functions */
 
@@ -23,23 +61,126 @@ HIDDEN pcb_t *pcbFree_h; /**< pointer to the head of a list of free ProcBlocks *
 *
 * Initialize the pcbFree list to contain all the elements of the
 * static array of MAXPROC ProcBlk’s. This method will be called
-* only once during data structure initialization.
+* only once during data structure initialization. More ProcBlk’s
+* can be added afterwards with growPcbs(). Constant time: the array
+* is only touched as its ProcBlk’s are first allocated (see slab.c).
 */
 void initPcbs(){
 
-	int i;
-	HIDDEN pcb_t pcbFree_table[MAXPROC];
-	pcb_t *tmp = NULL;
+#ifndef PCB_COMPACT
+	HIDDEN pcb_t pcbTable[MAXPROC];
+#endif
+	HIDDEN slab_t pcbSlab;
+
+	initPool(&pcbPool, sizeof(pcb_t));
+	addSlab(&pcbPool, &pcbSlab, pcbTable, MAXPROC);
+	initPids();
+#ifdef KAYA_SMP
+	{
+		int cpu;
+
+		for(cpu = 0; cpu < MAXCPU; cpu++)
+			pcbCache[cpu].pc_count = 0;
+		initLfStack(&pcbShared);
+		pcbStacked = 0;
+	}
+#endif
+
+}
+
+
+/**
+* @brief Add ProcBlk’s to the pcbFree list.
+*
+* Carve a new slab of ProcBlk’s out of a memory region supplied by the
+* caller, which must stay reserved to them from now on. With
+* PCB_COMPACT every ProcBlk must live in pcbTable, so none are added.
+*
+* @param mem The start of the region.
+* @param len The length of the region, in bytes.
+* @return The number of ProcBlk’s added.
+*/
+int growPcbs(void *mem, unsigned int len){
+
+#ifndef PCB_COMPACT
+	return growPool(&pcbPool, mem, len);
+#else
+	(void) mem;
+	(void) len;
+	return 0;
+#endif
+
+}
+
+
+#ifdef KAYA_SMP
+
+/* Return the number of free ProcBlk’s held by the caches and pcbShared,
+which pcbPool counts as used; exact only while no core allocates or frees */
+HIDDEN int pcbParked(void){
+
+	int cpu, n = __atomic_load_n(&pcbStacked, __ATOMIC_RELAXED);
+
+	for(cpu = 0; cpu < MAXCPU; cpu++)
+		n += __atomic_load_n(&pcbCache[cpu].pc_count, __ATOMIC_RELAXED);
+	return n;
+
+}
+
+#endif
+
+
+/**
+* Return the number of ProcBlk’s on the pcbFree list.
+*/
+int pcbFreeCount(void){
+
+#ifdef KAYA_SMP
+	return pcbPool.po_total - pcbPool.po_used + pcbParked();
+#else
+	return pcbPool.po_total - pcbPool.po_used;
+#endif
+
+}
 
-	/* Build a list out of the elements in pcbFree_table */
-	pcbFree_h = pcbFree_table;
-	tmp = pcbFree_h;
 
-	for(i=1; i<MAXPROC; i++){
-		tmp->p_next = pcbFree_table+i;
-		tmp = tmp->p_next;
+/**
+* Return the number of allocated ProcBlk’s.
+*/
+int pcbUsedCount(void){
+
+#ifdef KAYA_SMP
+	return pcbPool.po_used - pcbParked();
+#else
+	return pcbPool.po_used;
+#endif
+
+}
+
+
+/**
+* @brief Return the index of a ProcBlk in the pool.
+*
+* pcbTable holds indices 0 to MAXPROC-1; each slab added by growPcbs()
+* numbers its ProcBlk’s on from those of the slabs added before it. The
+* index only depends on where p lies, so it is stable across runs and
+* never shared by two ProcBlk’s. Linear in the number of slabs.
+*
+* @param p A pointer to a ProcBlk.
+* @return The index of p, or -1 if p lies in none of the slabs.
+*/
+int pcbIndex(pcb_t *p){
+
+	slab_t *sl;
+	unsigned int first = pcbPool.po_total;
+
+	/* slabs are linked most recent first: step first back past each */
+	for(sl = pcbPool.po_slabs; sl != NULL; sl = sl->sl_next){
+		first -= sl->sl_count;
+		if((char *) p >= sl->sl_base && (char *) p < sl->sl_end)
+			return first + (p - (pcb_t *) sl->sl_base);
 	}
-	tmp->p_next = NULL; /* list is NULL-terminated */
+	return -1;
 
 }
 
@@ -51,8 +192,52 @@ void initPcbs(){
 */
 void freePcb(pcb_t *p){
 
-	p->p_next = pcbFree_h;
-	pcbFree_h = p;
+	TRACE(TR_FREE, p, NULL);
+	releasePid(p);
+	freePool(&pcbPool, p);
+	STATINC(st_pcbFrees);
+
+}
+
+
+/**
+* @brief Give initial values to ALL the fields of a ProcBlk.
+*
+* ProcBlk’s get reused, so no previous value may persist in a
+* ProcBlk when it gets reallocated.
+*
+* @param p A pointer to the ProcBlk to be reset.
+*/
+HIDDEN void resetPcb(pcb_t *p){
+
+	SETPCBLINK(p, p_next, NULL);
+	SETPCBLINK(p, p_prev, NULL);
+	SETPCBLINK(p, p_prnt, NULL);
+	SETPCBLINK(p, p_child, NULL);
+	SETPCBLINK(p, p_sib, NULL);
+	SETPCBLINK(p, p_sprv, NULL);
+	SETPCBLINK(p, p_hchild, NULL);
+	PCBHOT(p, p_q) = NULL;
+	PCBHOT(p, p_level) = 0;
+	PCBHOT(p, p_rq) = -1;
+	PCBHOT(p, p_ticks) = 0;
+	p->p_s = 0;
+	p->p_semAdd = NULL;
+	p->p_semd = NULL;
+	p->p_semgen = 0;
+	p->p_ksem = NULL;
+	p->p_prio = 0;
+	p->p_eprio = 0;
+	p->p_hseq = 0;
+	p->p_tnext = NULL;
+	p->p_tprev = NULL;
+	p->p_tslot = NULL;
+	p->p_wake = 0;
+	p->p_twait = FALSE;
+	p->p_cpu = 0;
+	p->p_cputime = 0;
+	p->p_childtime = 0;
+	p->p_subtime = 0;
 
 }
 
@@ -72,25 +257,143 @@ void freePcb(pcb_t *p){
 */
 pcb_t *allocPcb(){
 
-	if(!pcbFree_h)
+	pcb_t *tmp = allocPool(&pcbPool);
+
+	if(!tmp){
+		STATINC(st_pcbAllocFails);
 		return NULL;
+	}
 	else{
-		pcb_t *tmp = NULL;
-		tmp = pcbFree_h;
-		pcbFree_h = tmp->p_next;
-		
-		tmp->p_next = NULL;
-		tmp->p_prnt = NULL;
-		tmp->p_child = NULL;
-		tmp->p_sib = NULL;
-		tmp->p_s = 0;
-		tmp->p_semAdd = NULL;
+		STATINC(st_pcbAllocs);
+		STATMAX(st_pcbPeak, pcbPool.po_used);
+		resetPcb(tmp);
+		assignPid(tmp);
+		TRACE(TR_ALLOC, tmp, NULL);
 		return tmp;
 	}
 
 }
 
 
+#ifdef KAYA_SMP
+
+/* Set the count of pc, a cache only its own core changes; see pcbParked() */
+HIDDEN void setCount(pcbcache_t *pc, int n){
+
+	__atomic_store_n(&pc->pc_count, n, __ATOMIC_RELAXED);
+
+}
+
+
+/* Pop a ProcBlk off pcbShared, or return NULL if it is empty */
+HIDDEN pcb_t *popShared(void){
+
+	pcb_t *p = popLfStack(&pcbShared);
+
+	if(p != NULL)
+		__atomic_sub_fetch(&pcbStacked, 1, __ATOMIC_RELAXED);
+	return p;
+
+}
+
+
+/* Push the ProcBlk p on pcbShared */
+HIDDEN void pushShared(pcb_t *p){
+
+	__atomic_add_fetch(&pcbStacked, 1, __ATOMIC_RELAXED);	/* before p can be popped */
+	pushLfStack(&pcbShared, p);
+
+}
+
+
+/**
+* @brief Allocate a ProcBlk on a given core.
+*
+* Like allocPcb(), but safe to call concurrently from different cores.
+*
+* @param cpu The number of the calling core, below MAXCPU.
+* @return A pointer to a ProcBlk with all its fields initialized,
+* 				 or NULL if no ProcBlk is free.
+*/
+pcb_t *allocPcbSMP(int cpu){
+
+	pcbcache_t *pc = &pcbCache[cpu];
+	pcb_t *p = NULL;
+	int n = pc->pc_count;
+
+	if(n == 0){		/* refill half the cache */
+		while(n < PCBCACHE / 2 && (p = popShared()) != NULL)
+			pc->pc_obj[n++] = p;
+		if(n == 0){
+			spinLock(&pcbPoolLock);
+			while(n < PCBCACHE / 2 && (p = allocPool(&pcbPool)) != NULL)
+				pc->pc_obj[n++] = p;
+			spinUnlock(&pcbPoolLock);
+		}
+		if(n == 0){
+			STATINC(st_pcbAllocFails);
+			return NULL;
+		}
+	}
+	p = pc->pc_obj[--n];
+	setCount(pc, n);
+	STATINC(st_pcbAllocs);
+	resetPcb(p);
+	assignPid(p);
+	TRACE(TR_ALLOC, p, NULL);
+	return p;
+
+}
+
+
+/**
+* @brief Free a ProcBlk on a given core.
+*
+* Like freePcb(), but safe to call concurrently from different cores.
+* The ProcBlk need not have been allocated on the same core.
+*
+* @param cpu The number of the calling core, below MAXCPU.
+* @param p A pointer to the ProcBlk to be freed.
+*/
+void freePcbSMP(int cpu, pcb_t *p){
+
+	pcbcache_t *pc = &pcbCache[cpu];
+	int n = pc->pc_count;
+
+	TRACE(TR_FREE, p, NULL);
+	releasePid(p);
+	if(n == PCBCACHE)	/* flush half the cache */
+		while(n > PCBCACHE / 2)
+			pushShared(pc->pc_obj[--n]);
+	pc->pc_obj[n++] = p;
+	setCount(pc, n);
+	STATINC(st_pcbFrees);
+
+}
+
+
+/**
+* @brief Release the cache of a core.
+*
+* Move every ProcBlk cached by core cpu to the shared stack, where the
+* other cores can allocate it; e.g. when the core goes offline.
+*
+* @param cpu The number of the calling core, below MAXCPU.
+*/
+void flushPcbCache(int cpu){
+
+	pcbcache_t *pc = &pcbCache[cpu];
+	int n = pc->pc_count;
+
+	while(n > 0)
+		pushShared(pc->pc_obj[--n]);
+	setCount(pc, n);
+
+}
+
+#endif
+
+
 /* Process Queues management */
 
 /**
@@ -125,6 +428,40 @@ int emptyProcQ(pcb_t *tp){
 }
 
 
+/**
+* @brief Unlink a ProcBlk from the ProcQ it is on.
+*
+* Constant time, since the queue is doubly linked. Only the tail of a
+* queue knows its tail pointer (p_q), and only the tail needs it: if p is
+* the tail the tail pointer is moved back to the previous element, which
+* takes over p_q. The links of p are cleared, which marks it as being on
+* no queue.
+*
+* @param *p A pointer to the pcb to be unlinked.
+*/
+HIDDEN void unlinkProcQ(pcb_t *p){
+
+	pcb_t *next = PCBLINK(p, p_next);
+	pcb_t *prev = PCBLINK(p, p_prev);
+	pcb_t **tp = PCBHOT(p, p_q);	/* NULL unless p is the tail */
+
+	if(next == p)			/* p is the only element */
+		*tp = NULL;
+	else{
+		SETPCBLINK(prev, p_next, next);
+		SETPCBLINK(next, p_prev, prev);
+		if(tp != NULL){		/* removing the tail */
+			*tp = prev;
+			PCBHOT(prev, p_q) = tp;
+		}
+	}
+	SETPCBLINK(p, p_next, NULL);
+	SETPCBLINK(p, p_prev, NULL);
+	PCBHOT(p, p_q) = NULL;
+
+}
+
+
 /**
 * @brief Insert a new ProcBlk in a ProcQ.
 *
@@ -137,15 +474,23 @@ int emptyProcQ(pcb_t *tp){
 */
 void insertProcQ(pcb_t **tp, pcb_t *p){
 
+	STATINC(st_qInserts);
+	TRACE(TR_QINSERT, p, tp);
 	if(*tp == NULL){
-		p->p_next = p;
-		*tp = p;
+		SETPCBLINK(p, p_next, p);
+		SETPCBLINK(p, p_prev, p);
 	}
 	else{
-		p->p_next = (*tp)->p_next;
-		(*tp)->p_next = p;
-		(*tp) = p;
+		pcb_t *head = PCBLINK(*tp, p_next);
+
+		SETPCBLINK(p, p_next, head);	/* p goes between the tail */
+		SETPCBLINK(p, p_prev, *tp);	/* and the head */
+		SETPCBLINK(head, p_prev, p);
+		SETPCBLINK(*tp, p_next, p);
+		PCBHOT(*tp, p_q) = NULL;	/* no longer the tail */
 	}
+	*tp = p;
+	PCBHOT(p, p_q) = tp;
 
 }
 
@@ -162,7 +507,7 @@ void insertProcQ(pcb_t **tp, pcb_t *p){
 pcb_t *headProcQ(pcb_t *tp){
 
 	if(tp)
-		return tp->p_next;
+		return PCBLINK(tp, p_next);
 	else
 		return NULL;
 
@@ -186,14 +531,11 @@ pcb_t *removeProcQ(pcb_t **tp){
 
 	if(*tp == NULL)		/* QUeue is empty */
 		return NULL;
-	else
-		tmp = (*tp)->p_next;
-
-	if(tmp == *tp)		/* If removing the only element in the */
-		*tp = NULL; 	/* queue, must update the tail pointer */
-	else
-		(*tp)->p_next = tmp->p_next;
 
+	STATINC(st_qRemoves);
+	tmp = PCBLINK(*tp, p_next);
+	unlinkProcQ(tmp);
+	TRACE(TR_QREMOVE, tmp, tp);
 	return tmp;
 
 }
@@ -207,45 +549,172 @@ pcb_t *removeProcQ(pcb_t **tp){
 * pointer if necessary. If the desired entry is not in the indicated queue
 * (an error condition), return NULL; otherwise, return p. Note that p
 * can point to any element of the process queue.
+*
+* Runs in constant time: p is unlinked through its own back link. The
+* check that p is on *tp is constant time too, and so only partial: the
+* tail of each queue records its tail pointer in p_q, which tells apart
+* an entry that is the tail, or the head, of another queue, or that is on
+* no queue at all. Naming the wrong queue for an entry further inside
+* another one is not detected; the entry is removed from the queue it is
+* on, which is left consistent.
 * 
 * @param **tp The address of a pointer to the tail of a Process Queue.
 * @param *p A pointer to the pcb to be removed from the queue.
 * @return A pointer to the removed ProcBlock, or NULL if an error occurs.
 */
 pcb_t *outProcQ(pcb_t **tp, pcb_t *p){
-	if (*tp == NULL)		/*if queue is empty return NULL*/
+
+	pcb_t *prev = PCBLINK(p, p_prev);
+
+	if(*tp == NULL || prev == NULL		/* empty queue, or p on none */
+	   || (PCBHOT(p, p_q) != NULL && PCBHOT(p, p_q) != tp)		/* tail of another */
+	   || (PCBHOT(prev, p_q) != NULL && PCBHOT(prev, p_q) != tp)){	/* head of another */
+		STATINC(st_qOutFails);
 		return NULL;
+	}
 
-	if ((*tp)->p_next == *tp) { 	/* queue only has one element.. */
-		if (*tp == p) {		
-			*tp = NULL;
-			return p;	
-		}
-		else
-			return NULL; /*..but not the element you're looking for*/
+	STATINC(st_qOuts);
+	unlinkProcQ(p);
+	TRACE(TR_QREMOVE, p, tp);
+	return p;
+
+}
+
+
+/**
+* @brief Remove a ProcBlk from whichever ProcQ holds it.
+*
+* For a caller that does not know the queue p is on, such as
+* terminateSubtree(). Constant time: only the tail of a queue has to
+* update the tail pointer, and it records where that is (p_q).
+*
+* @param p A pointer to a ProcBlk.
+* @return p, or NULL if it was on no queue.
+*/
+pcb_t *leaveProcQ(pcb_t *p){
+
+	if(PCBLINK(p, p_prev) == NULL)
+		return NULL;
+	STATINC(st_qOuts);
+	TRACE(TR_QREMOVE, p, PCBHOT(p, p_q));
+	unlinkProcQ(p);
+	return p;
+
+}
+
+
+/**
+* @brief Append a whole ProcQ to another one.
+*
+* Move every ProcBlk of the process queue whose tail-pointer is pointed
+* to by sp to the tail of the process queue whose tail-pointer is pointed
+* to by tp, keeping their order, and leave the first queue empty.
+* Constant time, whatever the length of either queue: only the tail of
+* each records its tail pointer (p_q), so only the new tail is updated.
+*
+* @param **tp The address of a pointer to the tail of the destination Process Queue.
+* @param **sp The address of a pointer to the tail of the Process Queue to be moved.
+*/
+void concatProcQ(pcb_t **tp, pcb_t **sp){
+
+	pcb_t *head = NULL;
+
+	STATINC(st_qConcats);
+	if(*sp == NULL)		/* nothing to move */
+		return;
+	TRACE(TR_QCONCAT, PCBLINK(*sp, p_next), tp);
+	if(*tp != NULL){	/* link tail(tp) -> head(sp) ... tail(sp) -> head(tp) */
+		head = PCBLINK(*tp, p_next);
+		SETPCBLINK(*tp, p_next, PCBLINK(*sp, p_next));
+		SETPCBLINK(PCBLINK(*sp, p_next), p_prev, *tp);
+		SETPCBLINK(*sp, p_next, head);
+		SETPCBLINK(head, p_prev, *sp);
+		PCBHOT(*tp, p_q) = NULL;
 	}
-	else {
-		pcb_t *aux = *tp;
-		/*scan the queue to determine if p is in the same queue *
-		 *pointed by tp						*/
-		while (aux->p_next != *tp) {
-			if (aux->p_next == p) {
-				aux->p_next = p->p_next;
-				return p;
-			}
-			aux = aux->p_next;
-		}
-		if (aux->p_next == p) { /* aux points to second to last pcb in queue */
-			aux->p_next = p->p_next; /* now aux is the queue tail */
-			return p;
-		}
-		return NULL; /* queue doesn't contain p*/
-	}		
-}	
+	*tp = *sp;
+	PCBHOT(*tp, p_q) = tp;
+	*sp = NULL;
+
+}
+
+
+/**
+* @brief Move the head of a process queue to the tail of another.
+*
+* Detach the first n ProcBlk’s of the queue whose tail is pointed to by
+* sp, or all of them if it holds fewer, and append them in order to the
+* queue whose tail is pointed to by tp. Takes time proportional to the
+* number of ProcBlk’s moved, as the cut has to be found by walking.
+*
+* @param tp The address of the tail pointer of the destination queue.
+* @param sp The address of the tail pointer of the source queue, a different one.
+* @param n The number of ProcBlk’s to move.
+* @return The number of ProcBlk’s moved.
+*/
+int splitProcQ(pcb_t **tp, pcb_t **sp, int n){
+
+	pcb_t *head, *last, *rest;
+	int moved = 1;
+
+	if(*sp == NULL || n <= 0)
+		return 0;
+	head = PCBLINK(*sp, p_next);
+	last = head;
+	TRACE(TR_QREMOVE, last, sp);
+	TRACE(TR_QINSERT, last, tp);
+	while(moved < n && last != *sp){
+		last = PCBLINK(last, p_next);
+		TRACE(TR_QREMOVE, last, sp);
+		TRACE(TR_QINSERT, last, tp);
+		moved++;
+	}
+
+	if(last == *sp)		/* the whole queue */
+		*sp = NULL;
+	else{			/* close head ... last and the rest into two rings */
+		rest = PCBLINK(last, p_next);
+		SETPCBLINK(*sp, p_next, rest);
+		SETPCBLINK(rest, p_prev, *sp);
+		SETPCBLINK(last, p_next, head);
+		SETPCBLINK(head, p_prev, last);
+	}
+	if(*tp != NULL){	/* as in concatProcQ() */
+		rest = PCBLINK(*tp, p_next);
+		SETPCBLINK(*tp, p_next, head);
+		SETPCBLINK(head, p_prev, *tp);
+		SETPCBLINK(last, p_next, rest);
+		SETPCBLINK(rest, p_prev, last);
+		PCBHOT(*tp, p_q) = NULL;
+	}
+	*tp = last;
+	PCBHOT(last, p_q) = tp;
+	return moved;
+
+}
 
 
 /* Process tree functions */
 
+/**
+* Add d to the subtree time of a and of each of its ancestors.
+*
+* Time proportional to the depth of a; nothing is done if d is 0, so
+* linking a new process costs constant time. Unsigned arithmetic wraps,
+* so adding 0 - t takes t away.
+*
+* @param a A pointer to a ProcBlk, or NULL.
+* @param d The time to add.
+*/
+HIDDEN void addSubtime(pcb_t *a, cputime_t d){
+
+	if(d == 0)
+		return;
+	for(; a != NULL; a = PCBLINK(a, p_prnt))
+		a->p_subtime += d;
+
+}
+
+
 /**
 * Return TRUE if the ProcBlk pointed to by p has no children. Return FALSE otherwise.
 *
@@ -255,7 +724,7 @@ pcb_t *outProcQ(pcb_t **tp, pcb_t *p){
 */
 int emptyChild(pcb_t *p){
 
-	if(p->p_child == NULL)
+	if(PCBLINK(p, p_child) == NULL)
 		return TRUE;
 	else
 		return FALSE;
@@ -264,16 +733,96 @@ int emptyChild(pcb_t *p){
 
 
 /**
-* Make the ProcBlk pointed to by p a child of the ProcBlk pointed to by prnt.
+* Make the ProcBlk pointed to by p the last child of the ProcBlk pointed to by prnt.
+*
+* Constant time if no CPU time has been billed to the subtree of p yet,
+* as for a new process. Otherwise that time is added to prnt and to each
+* of its ancestors, in time proportional to the depth of prnt.
 *
 * @param prnt A pointer to the ProcBlk that will become parent of *p
 * @param p A pointer to the ProcBlk to be inserted as a child of *prnt.
 */
 void insertChild(pcb_t *prnt, pcb_t *p){
 
-	p->p_sib = prnt->p_child;
-	prnt->p_child = p;
-	p->p_prnt = prnt;
+	pcb_t *first = PCBLINK(prnt, p_child);
+
+	STATINC(st_childInserts);
+	TRACE(TR_CHILD, p, prnt);
+	addSubtime(prnt, p->p_subtime);
+	SETPCBLINK(p, p_prnt, prnt);
+	SETPCBLINK(p, p_sib, NULL);
+	if(first == NULL){
+		SETPCBLINK(prnt, p_child, p);
+		SETPCBLINK(p, p_sprv, p);
+	}
+	else{		/* the last child is reached through the first */
+		SETPCBLINK(PCBLINK(first, p_sprv), p_sib, p);
+		SETPCBLINK(p, p_sprv, PCBLINK(first, p_sprv));
+		SETPCBLINK(first, p_sprv, p);
+	}
+
+}
+
+
+/**
+* Make the ProcBlk pointed to by p the first child of the ProcBlk pointed to by prnt.
+*
+* Takes the same time as insertChild().
+*
+* @param prnt A pointer to the ProcBlk that will become parent of *p
+* @param p A pointer to the ProcBlk to be inserted as a child of *prnt.
+*/
+void insertChildHead(pcb_t *prnt, pcb_t *p){
+
+	pcb_t *first = PCBLINK(prnt, p_child);
+
+	STATINC(st_childInserts);
+	TRACE(TR_CHILD, p, prnt);
+	addSubtime(prnt, p->p_subtime);
+	SETPCBLINK(p, p_prnt, prnt);
+	SETPCBLINK(p, p_sib, first);
+	if(first == NULL)
+		SETPCBLINK(p, p_sprv, p);
+	else{
+		SETPCBLINK(p, p_sprv, PCBLINK(first, p_sprv));
+		SETPCBLINK(first, p_sprv, p);
+	}
+	SETPCBLINK(prnt, p_child, p);
+
+}
+
+
+/**
+* Unlink the ProcBlk pointed to by p from the children of its parent prnt.
+*
+* Constant time: p's neighbours are p_sprv and p_sib, and the last child,
+* whose p_sprv the first child keeps, only changes if p is the last. The
+* subtree times are left to the caller.
+*
+* @param prnt A pointer to the parent of *p.
+* @param p A pointer to a child of *prnt.
+*/
+HIDDEN void unlinkChild(pcb_t *prnt, pcb_t *p){
+
+	pcb_t *first = PCBLINK(prnt, p_child);
+	pcb_t *next = PCBLINK(p, p_sib);
+
+	TRACE(TR_ORPHAN, p, prnt);
+	if(p == first){
+		SETPCBLINK(prnt, p_child, next);
+		if(next != NULL)
+			SETPCBLINK(next, p_sprv, PCBLINK(p, p_sprv));
+	}
+	else{
+		SETPCBLINK(PCBLINK(p, p_sprv), p_sib, next);
+		if(next != NULL)
+			SETPCBLINK(next, p_sprv, PCBLINK(p, p_sprv));
+		else		/* p was the last child */
+			SETPCBLINK(first, p_sprv, PCBLINK(p, p_sprv));
+	}
+	SETPCBLINK(p, p_prnt, NULL);
+	SETPCBLINK(p, p_sib, NULL);
+	SETPCBLINK(p, p_sprv, NULL);
 
 }
 
@@ -285,20 +834,24 @@ void insertChild(pcb_t *prnt, pcb_t *p){
 * child of p. Return NULL if initially there were no children of p.
 * Otherwise, return a pointer to this removed first child ProcBlk.
 *
+* The child is unlinked in constant time, but the time of its subtree is
+* then taken away from p and from each of its ancestors, in time
+* proportional to the depth of p, unless no time was billed to it.
+*
 * @param p A pointer to the ProcBlk whose first child is to be removed.
 * @return A pointer to the removed first child of *p, or NULL if *p has no children.
 */
 
 pcb_t *removeChild(pcb_t *p){
 
-	if(p->p_child == NULL) /*p has no child */
+	pcb_t *first = PCBLINK(p, p_child);
+
+	if(first == NULL) /*p has no child */
 		return NULL;
-	else{	/*remove the first child of p, return it (and its subtree) */
-		pcb_t *tmp = NULL;
-		tmp = p->p_child;
-		p->p_child = tmp->p_sib;
-		return tmp;
-	}
+	STATINC(st_childRemoves);
+	unlinkChild(p, first);	/* its own subtree goes with it */
+	addSubtime(p, 0 - first->p_subtime);
+	return first;
 
 }
 
@@ -310,31 +863,104 @@ pcb_t *removeChild(pcb_t *p){
 * Make the ProcBlk pointed to by p no longer the child of its parent.
 * If the ProcBlk pointed to by p has no parent, return NULL; otherwise,
 * return p. Note that the element pointed to by p need not be the first
-* child of its parent.
+* child of its parent: no scan of the siblings is needed either way.
+*
+* The unlinking is constant time, but the time of the subtree of p is
+* then taken away from its parent and from each of their ancestors, in
+* time proportional to the depth of p, unless no time was billed to it.
+* For a process that exits, reapChild() keeps the whole removal constant
+* time.
 *
 * @param p A pointer to the ProcBlock to be removed from its parent's list of children.
 * @return A pointer to the removed ProcBlk, or NULL if *p had no parent.
 */
 pcb_t* outChild(pcb_t *p){
 
-	if(p->p_prnt == NULL)	/* p has no parent */
+	pcb_t *prnt = PCBLINK(p, p_prnt);
+
+	if(prnt == NULL)	/* p has no parent */
 		return NULL;
+	STATINC(st_childOuts);
+	unlinkChild(prnt, p);
+	addSubtime(prnt, 0 - p->p_subtime);
+	return p;
 
-	if((p->p_prnt)->p_child == p){		/*p is the first child */
-		(p->p_prnt)->p_child = p->p_sib;
-	}
-	else{					/* p is NOT the first child */
-		pcb_t *tmp = NULL;		/* I need to scan the list  */
-		tmp = (p->p_prnt)->p_child;	/* of siblings for its */
-						/* and update it */
-		while(tmp->p_sib != p)
-			tmp = tmp->p_sib;
-
-		tmp->p_sib = p->p_sib;
-	}	
-	
-	p->p_prnt = NULL;
-	p->p_sib = NULL;
+}
+
+
+/**
+* @brief Remove an exiting process from its parent's children.
+*
+* Like outChild(), but the time of the subtree of p stays billed to its
+* parent, as time of exited descendants (p_childtime), so the subtree
+* times of the parent and of its ancestors do not change. Constant time.
+*
+* @param p A pointer to the ProcBlk of a process that is exiting.
+* @return p, or NULL if *p had no parent.
+*/
+pcb_t *reapChild(pcb_t *p){
+
+	pcb_t *prnt = PCBLINK(p, p_prnt);
+
+	if(prnt == NULL)
+		return NULL;
+	STATINC(st_childOuts);
+	unlinkChild(prnt, p);
+	prnt->p_childtime += p->p_subtime;
 	return p;
 
 }
+
+
+/* CPU time accounting functions */
+
+/**
+* @brief Bill CPU time to a process.
+*
+* Add t to the time of the ProcBlk pointed to by p, and to the subtree
+* time of p and of each of its ancestors. Not bounded by a constant: a
+* charge takes time proportional to the depth of p in the process tree,
+* at most the number of allocated ProcBlk’s. This is deliberate: the roll
+* up is paid here, once per charge, so that subtreeTime() stays constant
+* time for a scheduler reading it on every tick; deferring it to the
+* query would make each read walk the whole subtree instead.
+*
+* @param p A pointer to a ProcBlk.
+* @param t The time p has run for.
+*/
+void chargeTime(pcb_t *p, cputime_t t){
+
+	p->p_cputime += t;
+	addSubtime(p, t);
+
+}
+
+
+/**
+* Return the CPU time billed to the process itself.
+*
+* @param p A pointer to a ProcBlk.
+*/
+cputime_t cpuTime(pcb_t *p){
+
+	return p->p_cputime;
+
+}
+
+
+/**
+* @brief Return the CPU time of a process and all its descendants.
+*
+* Constant time: the total is kept up to date by chargeTime(), at a
+* cost proportional to the depth of the charged process, and by the tree
+* functions. It includes descendants that have exited through
+* reapChild() or terminateSubtree(), but not those moved elsewhere in
+* the tree with outChild() or removeChild().
+*
+* @param p A pointer to a ProcBlk.
+*/
+cputime_t subtreeTime(pcb_t *p){
+
+	return p->p_subtime;
+
+}
@@ -0,0 +1,159 @@
+/**
+* @file pid.c
+* @brief Function definitions for process identifiers.
+* @details Every ProcBlk is given a slot of the PID table the first time it
+* 				 is allocated, and keeps it for good, as ProcBlks never leave
+* 				 their pool. The slot holds a pointer to the ProcBlk and a
+* 				 generation, bumped when the ProcBlk is allocated and again when
+* 				 it is freed, so it is odd exactly while the process exists. A
+* 				 process identifier pairs the slot with the generation it was
+* 				 issued under: looking it up is one table access, and an
+* 				 identifier kept after its process was freed no longer matches,
+* 				 even once the ProcBlk has been recycled for another process.
+* 				 Generations wrap after 2^(32 - PIDSLOTBITS - 1) reuses of a
+* 				 slot, and only ProcBlks found a slot among the first MAXPIDS
+* 				 have identifiers: raise MAXPIDS with growPcbs().
+*/
+
+#include "const.h"
+#include "types.h"
+#include "pid.h"
+
+/**
+* @brief An entry of the PID table.
+*/
+typedef struct pidslot_t {
+	pcb_t *ps_pcb;		/* the ProcBlk owning the slot */
+	unsigned int ps_gen;	/* odd while ps_pcb is allocated */
+} pidslot_t;
+
+HIDDEN pidslot_t pidTable[MAXPIDS];
+HIDDEN unsigned int pidNext;		/* slots handed out so far */
+
+#define GENMASK ((1u << (32 - PIDSLOTBITS)) - 1)
+
+
+/* Return the number of slots handed out */
+HIDDEN unsigned int slotsUsed(void){
+#ifdef KAYA_SMP
+	return __atomic_load_n(&pidNext, __ATOMIC_ACQUIRE);
+#else
+	return pidNext;
+#endif
+}
+
+
+/* Return the generation of slot s */
+HIDDEN unsigned int slotGen(unsigned int s){
+#ifdef KAYA_SMP
+	return __atomic_load_n(&pidTable[s].ps_gen, __ATOMIC_ACQUIRE);
+#else
+	return pidTable[s].ps_gen;
+#endif
+}
+
+
+/* Give slot s, owned by the caller's ProcBlk, the next generation */
+HIDDEN void bumpGen(unsigned int s){
+#ifdef KAYA_SMP
+	__atomic_store_n(&pidTable[s].ps_gen, (pidTable[s].ps_gen + 1) & GENMASK, __ATOMIC_RELEASE);
+#else
+	pidTable[s].ps_gen = (pidTable[s].ps_gen + 1) & GENMASK;
+#endif
+}
+
+
+/**
+* Return the slot of the PID table owned by p, if any.
+*
+* @param p A pointer to a ProcBlk.
+* @return The slot of p, or MAXPIDS if p has none.
+*/
+HIDDEN unsigned int pidSlot(pcb_t *p){
+	unsigned int s = p->p_pid & PIDSLOTMASK;
+
+	/* p_pid may be left over from before initPids(): check the table */
+	if(p->p_pid == PIDNONE || s >= slotsUsed() || s >= MAXPIDS || pidTable[s].ps_pcb != p)
+		return MAXPIDS;
+	return s;
+}
+
+
+/**
+* Empty the PID table. Called by initPcbs().
+*/
+void initPids(void){
+	pidNext = 0;
+}
+
+
+/**
+* @brief Give a newly allocated ProcBlk a process identifier.
+*
+* Called by allocPcb(): the identifier differs from every one p had before.
+*
+* @param p A pointer to a ProcBlk just taken from the pcbFree list.
+*/
+void assignPid(pcb_t *p){
+	unsigned int s = pidSlot(p);
+
+	if(s == MAXPIDS){	/* first allocation: take a fresh slot */
+#ifdef KAYA_SMP
+		s = __atomic_fetch_add(&pidNext, 1, __ATOMIC_RELAXED);
+#else
+		s = pidNext++;
+#endif
+		if(s >= MAXPIDS){
+			p->p_pid = PIDNONE;
+			return;
+		}
+		pidTable[s].ps_pcb = p;
+		pidTable[s].ps_gen = 0;
+	}
+	bumpGen(s);		/* odd, so never the generation of PIDNONE */
+	p->p_pid = (pidTable[s].ps_gen << PIDSLOTBITS) | s;
+}
+
+
+/**
+* @brief Invalidate the process identifier of a ProcBlk being freed.
+*
+* Called by freePcb(): from now on pidPcb() returns NULL for it.
+*
+* @param p A pointer to an allocated ProcBlk.
+*/
+void releasePid(pcb_t *p){
+	unsigned int s = pidSlot(p);
+
+	if(s != MAXPIDS)
+		bumpGen(s);
+}
+
+
+/**
+* Return the process identifier of a ProcBlk.
+*
+* @param p A pointer to an allocated ProcBlk.
+* @return The identifier of p, or PIDNONE if it has none.
+*/
+kpid_t pcbPid(pcb_t *p){
+	return p->p_pid;
+}
+
+
+/**
+* @brief Find a process by identifier.
+*
+* Constant time, with no search of the process tree or of any queue.
+*
+* @param pid A process identifier.
+* @return A pointer to the ProcBlk of the process, or NULL if pid is
+* 	   PIDNONE or names a process that has been freed since.
+*/
+pcb_t *pidPcb(kpid_t pid){
+	unsigned int s = pid & PIDSLOTMASK, gen = pid >> PIDSLOTBITS;
+
+	if((gen & 1) == 0 || s >= MAXPIDS || s >= slotsUsed() || slotGen(s) != gen)
+		return NULL;		/* an even generation is a freed process */
+	return pidTable[s].ps_pcb;
+}
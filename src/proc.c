@@ -0,0 +1,89 @@
+/**
+* @file proc.c
+* @brief Function definitions for process lifetime operations.
+* @details These operations work on a process as a whole: its place in the
+* 				 process tree, the queue or semaphore it waits on, and the
+* 				 timer it may have armed, all of which are reached from the
+* 				 ProcBlk itself in constant time.
+*/
+
+#include "const.h"
+#include "types.h"
+#include "pcb.h"
+#include "asl.h"
+#include "ksem.h"
+#include "wheel.h"
+#include "runq.h"
+#include "proc.h"
+
+
+/**
+* Detach the ProcBlk pointed to by p from every queue it is on and free it.
+*
+* A blocked ProcBlk leaves its semaphore. Any other queued ProcBlk is
+* either on a per-core run queue, which p_rq names and outRunQ() leaves
+* with the queue's count and lock kept right, or on some other ProcQ, be
+* it a ready queue, an MLFQ level or a private queue, which leaveProcQ()
+* leaves without needing to know which.
+*
+* @param p A pointer to a ProcBlk with no children and no parent.
+*/
+HIDDEN void reapPcb(pcb_t *p){
+
+	int cpu;
+
+	if(outKsem(p) == NULL && (p->p_semd == NULL || outBlocked(p) == NULL)){
+		if((cpu = findRunQ(p)) >= 0)	/* not blocked: maybe ready */
+			outRunQ(cpu, p);
+		else
+			leaveProcQ(p);
+	}
+	outWheel(p);
+	freePcb(p);
+
+}
+
+
+/**
+* @brief Terminate a process and all its descendants.
+*
+* Make the ProcBlk pointed to by root no longer a child of its parent,
+* which keeps the CPU time of the subtree billed to it (see reapChild()),
+* then detach every ProcBlk of its subtree from whichever queue it is
+* on: the semaphore it is blocked on (giving a ksem_t back the unit
+* taken), a run queue, an MLFQ level or any other ProcQ. Cancel any
+* timer it has armed and return it to the pcbFree list. Under KAYA_SMP
+* no other core may queue, dequeue or steal the subtree's processes
+* meanwhile.
+*
+* The tree is walked in post-order through p_prnt, p_child and p_sib,
+* without recursion or auxiliary storage: from each node, descend to a
+* leaf through first children, then free the leaf and go back to its
+* parent. Every edge is descended once, and every ProcBlk leaves its
+* queue in constant time, so the whole subtree costs time linear in its
+* size.
+*
+* @param root A pointer to the ProcBlk at the root of the subtree.
+* @return The number of ProcBlks freed.
+*/
+int terminateSubtree(pcb_t *root){
+
+	pcb_t *p = root, *prnt = NULL;
+	int count = 0;
+
+	reapChild(root);
+	while(TRUE){
+		while(!emptyChild(p))		/* down to a leaf */
+			p = PCBLINK(p, p_child);
+		if(p == root)
+			break;
+		prnt = PCBLINK(p, p_prnt);
+		reapChild(p);			/* p is its first child */
+		reapPcb(p);
+		count++;
+		p = prnt;			/* then on to its next child */
+	}
+	reapPcb(root);
+	return count + 1;
+
+}
@@ -0,0 +1,210 @@
+/**
+* @file runq.c
+* @brief Function definitions for the per-core run queues.
+* @details Each core has a run queue of its own instead of all of them
+* 				 sharing one ready ProcQ: a core queues the processes it
+* 				 preempts or wakes on its own queue and picks the next one from
+* 				 there, so a process keeps running where its cache lines are.
+* 				 Each queue has its own lock, which only the owner takes while
+* 				 it has work. A core whose queue runs dry steals half of the
+* 				 queue of the busiest core in one batch (splitProcQ), taking the
+* 				 processes that have waited longest; it then runs on its own
+* 				 queue again until that too is empty, so thieves come back
+* 				 rarely and cores contend for a lock only while stealing.
+* 				 Nothing is allocated: the queues link the ProcBlks through
+* 				 p_next/p_prev, and p_rq tells which queue holds each of them.
+*/
+
+#include "const.h"
+#include "types.h"
+#include "runq.h"
+
+HIDDEN runq_t runQueue[MAXCPU];	/**< runQueue[cpu] is owned by core cpu */
+
+
+/* Add d to the count of rq, whose lock is held; see runQCount() */
+HIDDEN void addCount(runq_t *rq, int d){
+
+#ifdef KAYA_SMP
+	__atomic_store_n(&rq->rq_count, rq->rq_count + d, __ATOMIC_RELAXED);
+#else
+	rq->rq_count += d;
+#endif
+
+}
+
+
+/**
+* Initialize the run queue of every core to be empty.
+*/
+void initRunQs(void){
+
+	int i;
+
+	for(i = 0; i < MAXCPU; i++){
+		runQueue[i].rq_tail = mkEmptyProcQ();
+		runQueue[i].rq_count = 0;
+		runQueue[i].rq_lock = SPINUNLOCKED;
+	}
+
+}
+
+
+/**
+* @brief Make a process ready on a core.
+*
+* Append the ProcBlk pointed to by p to the run queue of core cpu. To
+* keep a woken process on the core it ran on last, pass p->p_cpu.
+*
+* @param cpu The number of a core.
+* @param p A pointer to a ProcBlk on no queue.
+*/
+void insertRunQ(int cpu, pcb_t *p){
+
+	runq_t *rq = &runQueue[cpu];
+
+	spinLock(&rq->rq_lock);
+	insertProcQ(&rq->rq_tail, p);
+	PCBHOT(p, p_rq) = cpu;
+	addCount(rq, 1);
+	spinUnlock(&rq->rq_lock);
+
+}
+
+
+/**
+* @brief Pick the next process for a core to run.
+*
+* Remove the head of the run queue of core cpu; if that is empty, steal
+* from the other cores first. The ProcBlk is marked as last run by cpu.
+*
+* @param cpu The number of the calling core.
+* @return A pointer to the removed ProcBlk, or NULL if no core has a
+* 				 ready process.
+*/
+pcb_t *removeRunQ(int cpu){
+
+	runq_t *rq = &runQueue[cpu];
+	pcb_t *p;
+
+	do{
+		spinLock(&rq->rq_lock);
+		if((p = removeProcQ(&rq->rq_tail)) != NULL){
+			PCBHOT(p, p_rq) = -1;
+			addCount(rq, -1);
+		}
+		spinUnlock(&rq->rq_lock);
+	}while(p == NULL && stealRunQ(cpu) > 0);
+	if(p != NULL)
+		p->p_cpu = cpu;
+	return p;
+
+}
+
+
+/**
+* Return the core whose run queue holds the ProcBlk pointed to by p, as
+* told by its p_rq. Without the lock the answer is only a hint: check it
+* with outRunQ().
+*
+* @param p A pointer to a ProcBlk.
+* @return The number of a core, or -1 if p is on no run queue.
+*/
+int findRunQ(pcb_t *p){
+
+	return PCBHOT(p, p_rq);
+
+}
+
+
+/**
+* Remove the ProcBlk pointed to by p from the run queue of core cpu,
+* e.g. because the process is being terminated. Whether p is on that
+* queue is decided under its lock, by p_rq, so a ProcBlk queued on, or
+* stolen by, another core is left alone.
+*
+* @param cpu The number of a core.
+* @param p A pointer to a ProcBlk.
+* @return p, or NULL if it was not on that queue.
+*/
+pcb_t *outRunQ(int cpu, pcb_t *p){
+
+	runq_t *rq = &runQueue[cpu];
+
+	spinLock(&rq->rq_lock);
+	if(PCBHOT(p, p_rq) != cpu)	/* only this lock's holder sets it so */
+		p = NULL;
+	else{
+		leaveProcQ(p);
+		PCBHOT(p, p_rq) = -1;
+		addCount(rq, -1);
+	}
+	spinUnlock(&rq->rq_lock);
+	return p;
+
+}
+
+
+/**
+* @brief Balance the load onto an idle core.
+*
+* Move half of the run queue of the core with the most ready processes,
+* rounding up, to the tail of the run queue of core cpu. The victim's
+* lock is held only while the batch is cut out and handed over to cpu in
+* p_rq, and never together with the thief's. Takes time proportional to
+* the number of ProcBlks moved.
+*
+* @param cpu The number of the calling core.
+* @return The number of ProcBlks moved; 0 if every other queue is empty.
+*/
+int stealRunQ(int cpu){
+
+	pcb_t *batch = mkEmptyProcQ();
+	runq_t *rq;
+	pcb_t *p;
+	int i, n, victim = -1, most = 0;
+
+	for(i = 0; i < MAXCPU; i++)	/* a hint: counts may change under us */
+		if(i != cpu && (n = runQCount(i)) > most){
+			most = n;
+			victim = i;
+		}
+	if(victim < 0)
+		return 0;
+
+	rq = &runQueue[victim];
+	spinLock(&rq->rq_lock);
+	n = splitProcQ(&batch, &rq->rq_tail, (rq->rq_count + 1) >> 1);
+	addCount(rq, -n);
+	for(i = 0, p = batch; i < n; i++, p = PCBLINK(p, p_next))
+		PCBHOT(p, p_rq) = cpu;
+	spinUnlock(&rq->rq_lock);
+	if(n == 0)
+		return 0;
+
+	rq = &runQueue[cpu];
+	spinLock(&rq->rq_lock);
+	concatProcQ(&rq->rq_tail, &batch);
+	addCount(rq, n);
+	spinUnlock(&rq->rq_lock);
+	return n;
+
+}
+
+
+/**
+* Return the number of processes ready on core cpu. Without the lock the
+* value may be stale by the time it is used.
+*
+* @param cpu The number of a core.
+* @return The length of the run queue of cpu.
+*/
+int runQCount(int cpu){
+
+#ifdef KAYA_SMP
+	return __atomic_load_n(&runQueue[cpu].rq_count, __ATOMIC_RELAXED);
+#else
+	return runQueue[cpu].rq_count;
+#endif
+
+}
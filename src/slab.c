@@ -0,0 +1,145 @@
+/**
+* @file slab.c
+* @brief Function definitions for the slab allocator.
+* @details A pool hands out fixed size objects carved from slabs, each a
+* 				 contiguous array of objects, so that consecutive allocations stay
+* 				 close in memory. The first slab is usually a static array sized
+* 				 at build time; more can be added at any time from memory regions
+* 				 supplied by the caller. Nothing is ever returned to the caller:
+* 				 pools only grow. Slabs are initialized lazily: adding one only
+* 				 records its bounds, and its objects are handed out by bumping
+* 				 a pointer the first time they are needed, so setting up a pool
+* 				 takes constant time whatever its capacity, and objects never
+* 				 allocated are never touched. Freed objects are recycled first,
+* 				 most recently freed first.
+*/
+
+#include "const.h"
+#include "slab.h"
+
+/* Round n up to a multiple of SLABALIGN */
+#define SLABROUND(n) (((n) + SLABALIGN - 1) & ~(unsigned long)(SLABALIGN - 1))
+
+
+/**
+* @brief Initialize an empty pool.
+*
+* @param po A pointer to the pool to be initialized.
+* @param size The size of the objects, in bytes; at least a pointer.
+*/
+void initPool(pool_t *po, unsigned int size){
+
+	po->po_free = NULL;
+	po->po_slabs = NULL;
+	po->po_fresh = NULL;
+	po->po_size = size;
+	po->po_total = 0;
+	po->po_used = 0;
+
+}
+
+
+/**
+* @brief Add a slab made of an existing array of objects to a pool.
+*
+* Constant time: the objects of the array are handed out in array order,
+* before those of older slabs, once no freed object is left to recycle,
+* and are not touched until then.
+*
+* @param po A pointer to the pool.
+* @param sl A pointer to the header describing the new slab.
+* @param objs The first of count contiguous objects of the pool's size.
+* @param count The number of objects.
+*/
+void addSlab(pool_t *po, slab_t *sl, void *objs, unsigned int count){
+
+	sl->sl_base = objs;
+	sl->sl_count = count;
+	sl->sl_fresh = objs;
+	sl->sl_end = (char *) objs + (unsigned long) count * po->po_size;
+	sl->sl_next = po->po_slabs;
+	po->po_slabs = sl;
+	po->po_fresh = sl;
+	po->po_total += count;
+
+}
+
+
+/**
+* @brief Grow a pool by a slab carved from a memory region.
+*
+* The slab header is placed at the start of the region and is followed by
+* as many aligned objects as fit.
+*
+* @param po A pointer to the pool.
+* @param mem The start of the region; it must stay reserved to the pool.
+* @param len The length of the region, in bytes.
+* @return The number of objects added, 0 if the region is too small.
+*/
+int growPool(pool_t *po, void *mem, unsigned int len){
+
+	unsigned long start = SLABROUND((unsigned long) mem);
+	unsigned long objs = SLABROUND(start + sizeof(slab_t));
+	unsigned long end = (unsigned long) mem + len;
+	unsigned long next = objs;
+	unsigned int count = 0;
+
+	/* counted rather than divided: uARM has no divide instruction */
+	while(next + po->po_size <= end){
+		next += po->po_size;
+		count++;
+	}
+	if(count == 0)
+		return 0;
+	addSlab(po, (slab_t *) start, (void *) objs, count);
+	return count;
+
+}
+
+
+/**
+* @brief Allocate an object from a pool.
+*
+* The most recently freed object is recycled if there is one; otherwise
+* the next object never handed out is taken from the slabs. The contents
+* of the object are undefined.
+*
+* @param po A pointer to the pool.
+* @return A pointer to the object, or NULL if the pool is exhausted.
+*/
+void *allocPool(pool_t *po){
+
+	void *obj = po->po_free;
+	slab_t *sl;
+
+	if(obj != NULL)
+		po->po_free = *(void **) obj;
+	else{
+		/* slabs left behind are used up, except older ones still being
+		 * bumped when a newer slab was added: they come next */
+		while((sl = po->po_fresh) != NULL && sl->sl_fresh == sl->sl_end)
+			po->po_fresh = sl->sl_next;
+		if(sl == NULL)
+			return NULL;
+		obj = sl->sl_fresh;
+		sl->sl_fresh += po->po_size;
+	}
+	po->po_used++;
+	return obj;
+
+}
+
+
+/**
+* Return an object to the pool it was allocated from.
+*
+* @param po A pointer to the pool.
+* @param obj A pointer to the object.
+*/
+void freePool(pool_t *po, void *obj){
+
+	*(void **) obj = po->po_free;
+	po->po_free = obj;
+	po->po_used--;
+
+}
@@ -0,0 +1,150 @@
+/**
+* @file stats.c
+* @brief Function definitions for reading the phase 1 operation counters.
+* @details The counters themselves are bumped in place by the STAT macros of
+* 				 stats.h; this file only holds them and reports them.
+*/
+
+#include "const.h"
+#include "pcb.h"
+#include "asl.h"
+#include "stats.h"
+#include "libuarm.h"
+
+#ifdef KAYA_STATS
+kstats_t kstats;	/* the counters */
+#endif
+
+
+/**
+* @brief Take a snapshot of the counters.
+*
+* Copy every counter to *st, and fill in the current occupancy of the
+* ProcBlk and descriptor pools. Without KAYA_STATS only the occupancy is
+* meaningful.
+*
+* @param st A pointer to the structure to fill.
+*/
+void getStats(kstats_t *st){
+
+#ifdef KAYA_STATS
+	*st = kstats;
+#else
+	char *c = (char *) st;
+	unsigned int i;
+
+	for(i = 0; i < sizeof(kstats_t); i++)
+		c[i] = 0;
+#endif
+	st->st_pcbInUse = pcbUsedCount();
+	st->st_pcbAvail = pcbFreeCount();
+	st->st_semdInUse = semdUsedCount();
+	st->st_semdAvail = semdFreeCount();
+
+}
+
+
+/**
+* Zero every counter. The high-water marks start over from the current
+* occupancy.
+*/
+void resetStats(void){
+
+#ifdef KAYA_STATS
+	char *c = (char *) &kstats;
+	unsigned int i;
+
+	for(i = 0; i < sizeof(kstats_t); i++)
+		c[i] = 0;
+	kstats.st_pcbPeak = pcbUsedCount();
+	kstats.st_semdPeak = semdUsedCount();
+#endif
+
+}
+
+
+/**
+* Print an unsigned number on the terminal. Digits are found by repeated
+* subtraction, as uARM has no divide instruction.
+*
+* @param n The number to print.
+*/
+HIDDEN void printNum(unsigned long n){
+
+	unsigned long pw[20];	/* enough for 64 bit longs */
+	char buf[24], *c = buf;
+	int k = 0;
+
+	pw[0] = 1;
+	while(pw[k] <= ~0UL / 10 && pw[k] * 10 <= n){
+		pw[k+1] = pw[k] * 10;
+		k++;
+	}
+	for(; k >= 0; k--){
+		*c = '0';
+		while(n >= pw[k]){
+			n -= pw[k];
+			(*c)++;
+		}
+		c++;
+	}
+	*c = '\0';
+	tprint(buf);
+
+}
+
+
+/* Print one "name value" line */
+HIDDEN void printStat(char *name, unsigned long value){
+
+	tprint(name);
+	tprint(" ");
+	printNum(value);
+	tprint("\n");
+
+}
+
+
+/**
+* @brief Print every counter on the terminal, one per line.
+*/
+void dumpStats(void){
+
+	kstats_t st;
+
+	getStats(&st);
+#ifndef KAYA_STATS
+	tprint("stats: counters not compiled in (KAYA_STATS)\n");
+#endif
+	printStat("pcb.allocs", st.st_pcbAllocs);
+	printStat("pcb.allocFails", st.st_pcbAllocFails);
+	printStat("pcb.frees", st.st_pcbFrees);
+	printStat("pcb.peak", st.st_pcbPeak);
+	printStat("pcb.inUse", st.st_pcbInUse);
+	printStat("pcb.avail", st.st_pcbAvail);
+	printStat("procq.inserts", st.st_qInserts);
+	printStat("procq.removes", st.st_qRemoves);
+	printStat("procq.outs", st.st_qOuts);
+	printStat("procq.outFails", st.st_qOutFails);
+	printStat("procq.concats", st.st_qConcats);
+	printStat("tree.inserts", st.st_childInserts);
+	printStat("tree.removes", st.st_childRemoves);
+	printStat("tree.outs", st.st_childOuts);
+	printStat("asl.inserts", st.st_aslInserts);
+	printStat("asl.insertFails", st.st_aslInsertFails);
+	printStat("asl.removes", st.st_aslRemoves);
+	printStat("asl.outs", st.st_aslOuts);
+	printStat("asl.outFails", st.st_aslOutFails);
+	printStat("asl.heads", st.st_aslHeads);
+	printStat("asl.removeAlls", st.st_aslRemoveAlls);
+	printStat("asl.lookups", st.st_aslLookups);
+	printStat("asl.misses", st.st_aslMisses);
+	printStat("asl.visits", st.st_aslVisits);
+	printStat("asl.direct", st.st_aslDirect);
+	printStat("semd.peak", st.st_semdPeak);
+	printStat("semd.inUse", st.st_semdInUse);
+	printStat("semd.avail", st.st_semdAvail);
+	printStat("semd.queuePeak", st.st_semQueuePeak);
+	printStat("sem.fast", st.st_semFast);
+
+}
@@ -0,0 +1,135 @@
+/**
+* @file trace.c
+* @brief Function definitions for the event trace.
+* @details With KAYA_TRACE defined, the hot paths of pcb.c and asl.c record
+* 				 what they do to ProcBlks in a fixed ring of TRACESIZE binary
+* 				 events. Recording costs a timestamp read and a 16 byte store: a
+* 				 running count picks the slot, so when the ring is full the
+* 				 oldest event is overwritten and nothing is ever allocated. In
+* 				 the multicore build the count is advanced atomically, so cores
+* 				 never share a slot; an event being written while the ring is
+* 				 read may come out torn. dumpTrace() images are turned into
+* 				 Chrome trace JSON by tools/trace2json.c.
+*/
+
+#include "const.h"
+#include "pcb.h"
+#include "trace.h"
+#include "libuarm.h"
+
+HIDDEN trevent_t traceRing[TRACESIZE];	/* the last TRACESIZE events */
+HIDDEN unsigned int traceCount;		/* events recorded since resetTrace() */
+
+
+/**
+* Return the number identifying a ProcBlk in the trace: its index in the
+* ProcBlk pool (see pcbIndex()), the same in every build and every run.
+*
+* @param p A pointer to a ProcBlk, or NULL.
+* @return The identifier of p; 0xFFFFFFFF for NULL.
+*/
+unsigned int tracePcb(pcb_t *p){
+
+	if(p == NULL)
+		return 0xFFFFFFFF;
+	return (unsigned int) pcbIndex(p);
+
+}
+
+
+/**
+* @brief Record an event.
+*
+* Called through the TRACE() macro, which compiles to nothing without
+* KAYA_TRACE.
+*
+* @param type One of the TR_* event types.
+* @param p The ProcBlk the event is about.
+* @param obj The semaphore or queue address, or the other ProcBlk of a
+* 				 TR_CHILD or TR_ORPHAN event.
+*/
+void traceEvent(int type, pcb_t *p, const void *obj){
+
+	unsigned int i;
+	trevent_t *ev;
+
+#ifdef KAYA_SMP
+	i = __atomic_fetch_add(&traceCount, 1, __ATOMIC_RELAXED);
+#else
+	i = traceCount++;
+#endif
+	ev = &traceRing[i & (TRACESIZE - 1)];
+	ev->te_time = getTODLO();
+	ev->te_type = type;
+	ev->te_pcb = tracePcb(p);
+	if(type == TR_CHILD || type == TR_ORPHAN)
+		ev->te_arg = tracePcb((pcb_t *) obj);
+	else
+		ev->te_arg = (unsigned int) (unsigned long) obj;
+	ev->te_pad = 0;
+
+}
+
+
+/**
+* Discard every recorded event.
+*/
+void resetTrace(void){
+
+	traceCount = 0;
+
+}
+
+
+/**
+* @brief Copy the most recent events out of the ring.
+*
+* @param ev An array of at least max events.
+* @param max The number of events to copy, at most.
+* @return The number of events copied to ev, oldest first.
+*/
+int readTrace(trevent_t *ev, int max){
+
+	unsigned int count = traceCount, n, i;
+
+	n = count < TRACESIZE ? count : TRACESIZE;
+	if(max < 0)
+		max = 0;
+	if(n > (unsigned int) max)
+		n = max;
+	for(i = 0; i < n; i++)
+		ev[i] = traceRing[(count - n + i) & (TRACESIZE - 1)];
+	return n;
+
+}
+
+
+/**
+* @brief Write a self-describing image of the trace.
+*
+* Fill buf with a trheader_t followed by the events in the ring, oldest
+* first: as many as fit in len bytes, the most recent ones if not all do.
+* The image can be saved from the emulator or the host and converted.
+*
+* @param buf The start of a buffer, aligned for an unsigned int.
+* @param len The length of the buffer, in bytes.
+* @return The number of bytes written; 0 if not even the header fits.
+*/
+unsigned int dumpTrace(void *buf, unsigned int len){
+
+	trheader_t *th = buf;
+	unsigned int count = traceCount, n;
+
+	if(len < sizeof(trheader_t))
+		return 0;
+	th->th_magic[0] = 'K';
+	th->th_magic[1] = 'T';
+	th->th_magic[2] = 'R';
+	th->th_magic[3] = 'C';
+	n = readTrace((trevent_t *) (th + 1), (len - sizeof(trheader_t)) / sizeof(trevent_t));
+	th->th_count = n;
+	th->th_lost = count - n;
+	th->th_size = TRACESIZE;
+	return sizeof(trheader_t) + n * sizeof(trevent_t);
+
+}
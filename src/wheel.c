@@ -0,0 +1,170 @@
+/**
+* @file wheel.c
+* @brief Function definitions for the timing wheel.
+* @details A timing wheel holds ProcBlks by wake-up tick in WHEELLEVELS
+* 				 levels of WHEELSLOTS slots each, every slot a circular queue
+* 				 linked through p_tnext/p_tprev. A ProcBlk goes in the lowest
+* 				 level whose span covers its timeout, so inserting and
+* 				 cancelling are constant time. When the low bits of the clock
+* 				 wrap, the current slot of the level above is cascaded into the
+* 				 levels below; a ProcBlk moves at most WHEELLEVELS - 1 times
+* 				 before it expires, so a tick costs amortized constant time per
+* 				 expiring ProcBlk, whatever the number of sleepers.
+*/
+
+#include "const.h"
+#include "types.h"
+#include "wheel.h"
+#include "asl.h"
+
+
+/**
+* Append p to the timer queue whose tail-pointer is pointed to by tp.
+*
+* @param tp The address of the tail pointer of a slot.
+* @param p A pointer to a ProcBlk on no timer queue.
+*/
+HIDDEN void linkTimer(pcb_t **tp, pcb_t *p){
+
+	if(*tp == NULL){
+		p->p_tnext = p;
+		p->p_tprev = p;
+	}
+	else{
+		p->p_tnext = (*tp)->p_tnext;
+		p->p_tprev = *tp;
+		(*tp)->p_tnext->p_tprev = p;
+		(*tp)->p_tnext = p;
+	}
+	*tp = p;
+	p->p_tslot = tp;
+
+}
+
+
+/**
+* Put p in the slot of w matching its wake-up tick.
+*
+* @param w A pointer to a timing wheel.
+* @param p A pointer to a ProcBlk on no timer queue, due within WHEELMAX ticks.
+*/
+HIDDEN void placeTimer(wheel_t *w, pcb_t *p){
+
+	unsigned int delta = p->p_wake - w->tw_now;
+	int level = 0;
+
+	while(level < WHEELLEVELS - 1 && (delta >> (WHEELBITS * (level + 1))) != 0)
+		level++;
+	linkTimer(&(w->tw_slot[level][(p->p_wake >> (WHEELBITS * level)) & WHEELMASK]), p);
+
+}
+
+
+/**
+* Initialize an empty timing wheel, with its clock at tick 0.
+*
+* @param w A pointer to the wheel to be initialized.
+*/
+void initWheel(wheel_t *w){
+
+	int l, i;
+
+	for(l = 0; l < WHEELLEVELS; l++)
+		for(i = 0; i < WHEELSLOTS; i++)
+			w->tw_slot[l][i] = NULL;
+	w->tw_now = 0;
+
+}
+
+
+/**
+* @brief Arm a timer on a ProcBlk.
+*
+* Insert the ProcBlk pointed to by p in the wheel, to be returned by the
+* tickWheel() call that is ticks ticks from now. A timeout of 0 is taken
+* as 1, and one over WHEELMAX as WHEELMAX.
+*
+* @param w A pointer to a timing wheel.
+* @param p A pointer to a ProcBlk with no timer armed.
+* @param ticks The timeout, in ticks.
+*/
+void insertWheel(wheel_t *w, pcb_t *p, unsigned int ticks){
+
+	if(ticks == 0)
+		ticks = 1;
+	else if(ticks > WHEELMAX)
+		ticks = WHEELMAX;
+	p->p_wake = w->tw_now + ticks;
+	placeTimer(w, p);
+
+}
+
+
+/**
+* @brief Cancel the timer of a ProcBlk.
+*
+* Remove the ProcBlk pointed to by p from the timer queue it is on;
+* no search is needed, as p->p_tslot points to the queue.
+*
+* @param p A pointer to a ProcBlk.
+* @return p, or NULL if p had no timer armed.
+*/
+pcb_t *outWheel(pcb_t *p){
+
+	pcb_t **tp = p->p_tslot;
+
+	if(tp == NULL)
+		return NULL;
+	if(p->p_tnext == p)
+		*tp = NULL;
+	else{
+		p->p_tprev->p_tnext = p->p_tnext;
+		p->p_tnext->p_tprev = p->p_tprev;
+		if(*tp == p)
+			*tp = p->p_tprev;
+	}
+	p->p_tnext = NULL;
+	p->p_tprev = NULL;
+	p->p_tslot = NULL;
+	return p;
+
+}
+
+
+/**
+* @brief Advance the clock of a timing wheel by one tick.
+*
+* Cascade the slots of the upper levels that the new tick enters, then
+* expire every ProcBlk due at the new tick: a ProcBlk whose timer was armed
+* by insertBlockedTimed() is first removed from its semaphore's queue.
+* The expired ProcBlks are appended, in no particular order, to the
+* process queue whose tail-pointer is pointed to by tp.
+*
+* @param w A pointer to a timing wheel.
+* @param tp The address of a pointer to the tail of a Process Queue.
+* @return The number of ProcBlks moved to *tp.
+*/
+int tickWheel(wheel_t *w, pcb_t **tp){
+
+	pcb_t *slot, *p;
+	int l, i, count = 0;
+
+	w->tw_now++;
+	for(l = 1; l < WHEELLEVELS && (w->tw_now & ((1u << (WHEELBITS * l)) - 1)) == 0; l++)
+		;
+	while(--l > 0){		/* from the highest level that wrapped down */
+		i = (w->tw_now >> (WHEELBITS * l)) & WHEELMASK;
+		while((slot = w->tw_slot[l][i]) != NULL)	/* never placed back in slot i */
+			placeTimer(w, outWheel(slot->p_tnext));
+	}
+
+	while((slot = w->tw_slot[0][w->tw_now & WHEELMASK]) != NULL){
+		p = outWheel(slot->p_tnext);
+		if(p->p_twait)
+			outBlocked(p);
+		insertProcQ(tp, p);
+		count++;
+	}
+	return count;
+
+}
@@ -45,7 +45,7 @@ char errbuf[128];			/* contains reason for failing */
 char msgbuf[128];			/* nonrecoverable error message before shut down */
 int sem[MAXSEM];
 int onesem;
-pcb_t	*procp[MAXPROC], *p, *qa, *q, *firstproc, *lastproc, *midproc;
+pcb_t	*procp[MAXPROC], *p, *qa, *qb, *q, *firstproc, *lastproc, *midproc;
 char *mp = okbuf;
 
 /* This function places the specified character string in okbuf and
@@ -122,8 +122,17 @@ int main() {
 	q = outProcQ(&qa, midproc);
 	if (q == NULL || q != midproc)
 		adderrbuf("outProcQ(&qa, midproc) failed on middle entry   ");
+	if (outProcQ(&qa, midproc) != NULL)
+		adderrbuf("outProcQ(&qa, midproc) removed the same entry twice   ");
 	freePcb(q);
 
+	qb = mkEmptyProcQ();
+	insertProcQ(&qb, procp[1]);
+	if (outProcQ(&qa, procp[1]) != NULL)
+		adderrbuf("outProcQ(&qa, procp[1]) removed an entry of another queue   ");
+	if (headProcQ(qa) == NULL || removeProcQ(&qb) != procp[1] || !emptyProcQ(qb))
+		adderrbuf("outProcQ(&qa, procp[1]) corrupted the queues   ");
+
 	if (outProcQ(&qa, procp[0]) != NULL)
 		adderrbuf("outProcQ(&qa, procp[0]) failed on nonexistent entry   ");
 	addokbuf("outProcQ() ok   \n");
@@ -0,0 +1,943 @@
+/*********************************P1XTEST.C******************************
+ *
+ *	Test program for the extensions to the phase 1 modules that are
+ *	not covered by p1test.c.
+ *
+ *	Like p1test, produces progress messages on terminal 0 and
+ *		aborts as soon as an error is detected.
+ */
+
+#include "const.h"
+#include "types.h"
+
+#include "libuarm.h"
+#include "pcb.h"
+#include "asl.h"
+#include "mlfq.h"
+#include "stats.h"
+#include "wheel.h"
+#include "proc.h"
+#include "runq.h"
+#include "pid.h"
+#include "ksem.h"
+
+int devsem[8];
+int dirsem[10];	/* eight device semaphores and a pseudo-clock, direct-indexed, and a spare */
+int sem[MAXPROC];
+int wide[4 * MAXPROC];	/* wider than the ASL hash table */
+pcb_t *procp[MAXPROC], *q, *tp;
+
+/* This function causes the specified character string to be
+ *	written out to terminal0 */
+void addokbuf(char *strp) {
+	tprint(strp);
+}
+
+
+/* This function causes the specified character string to be written
+ *	out to terminal0, then shuts the system down with a panic message */
+void adderrbuf(char *strp) {
+	tprint(strp);
+	PANIC();
+}
+
+
+/* Check removeBlockedRange() on a block of device semaphores */
+void testRange(void) {
+	int i;
+	kstats_t before, after;
+
+	for (i = 0; i < 8; i++) {
+		procp[i] = allocPcb();
+		if (insertBlocked(&devsem[i / 2], procp[i]))
+			adderrbuf("insertBlocked(): unexpected TRUE   ");
+	}
+
+	/* devsem[1] and devsem[2] hold procp[2..5] */
+	tp = mkEmptyProcQ();
+	if (removeBlockedRange(&devsem[1], &devsem[3], &tp) != 4)
+		adderrbuf("removeBlockedRange(): wrong count   ");
+	if (headBlocked(&devsem[1]) != NULL || headBlocked(&devsem[2]) != NULL)
+		adderrbuf("removeBlockedRange(): left waiters in range   ");
+	if (headBlocked(&devsem[0]) != procp[0] || headBlocked(&devsem[3]) != procp[6])
+		adderrbuf("removeBlockedRange(): touched waiters out of range   ");
+	for (i = 0; i < 4; i++) {
+		if ((q = removeProcQ(&tp)) == NULL)
+			adderrbuf("removeBlockedRange(): missing process   ");
+		if (q->p_semAdd != &devsem[1] && q->p_semAdd != &devsem[2])
+			adderrbuf("removeBlockedRange(): wrong process   ");
+	}
+	if (removeBlockedRange(&devsem[1], &devsem[3], &tp) != 0)
+		adderrbuf("removeBlockedRange(): range not emptied   ");
+
+	if (removeBlockedRange(&devsem[0], &devsem[8], &tp) != 4)
+		adderrbuf("removeBlockedRange(): whole block not drained   ");
+	while ((q = removeProcQ(&tp)) != NULL)
+		freePcb(q);
+	for (i = 2; i < 6; i++)
+		freePcb(procp[i]);
+
+	/* every descriptor must be back on the free list */
+	for (i = 0; i < MAXPROC; i++) {
+		procp[i] = allocPcb();
+		if (insertBlocked(&sem[i], procp[i]))
+			adderrbuf("removeBlockedRange(): descriptors not freed   ");
+	}
+	if (removeBlockedRange(&sem[0], &sem[MAXPROC], &tp) != MAXPROC)
+		adderrbuf("removeBlockedRange(): sparse range not drained   ");
+	while ((q = removeProcQ(&tp)) != NULL)
+		freePcb(q);
+
+	/* a range wider than the hash table is not probed address by address */
+	for (i = 0; i < 3; i++)
+		procp[i] = allocPcb();
+	getStats(&before);
+	if (insertBlocked(&wide[0], procp[0]) || insertBlocked(&wide[4 * MAXPROC - 1], procp[1])
+	    || insertBlocked(&devsem[0], procp[2]))
+		adderrbuf("insertBlocked(): unexpected TRUE   ");
+	if (removeBlockedRange(&wide[0], &wide[4 * MAXPROC], &tp) != 2)
+		adderrbuf("removeBlockedRange(): wide range not drained   ");
+	getStats(&after);
+	if (after.st_aslLookups - before.st_aslLookups > 3)
+		adderrbuf("removeBlockedRange(): wide range looked up address by address   ");
+	if (headBlocked(&devsem[0]) != procp[2] || removeBlocked(&devsem[0]) != procp[2])
+		adderrbuf("removeBlockedRange(): touched waiters out of a wide range   ");
+	while ((q = removeProcQ(&tp)) != NULL)
+		freePcb(q);
+	freePcb(procp[2]);
+	addokbuf("removeBlockedRange() ok   \n");
+}
+
+
+/* Check that outBlocked() deactivates the semaphores it empties */
+void testOutBlocked(void) {
+	int i;
+
+	for (i = 0; i < MAXPROC; i++) {
+		procp[i] = allocPcb();
+		if (insertBlocked(&sem[i], procp[i]))
+			adderrbuf("insertBlocked(): unexpected TRUE   ");
+	}
+	if (outBlocked(procp[3]) != procp[3] || procp[3]->p_semd != NULL)
+		adderrbuf("outBlocked(): couldn't remove from valid queue   ");
+	if (outBlocked(procp[3]) != NULL)
+		adderrbuf("outBlocked(): removed same process twice   ");
+	if (headBlocked(&sem[3]) != NULL)
+		adderrbuf("outBlocked(): left an empty semaphore active   ");
+	if (insertBlocked(&devsem[0], procp[3]))
+		adderrbuf("outBlocked(): descriptor not returned to free list   ");
+	if (removeBlocked(&devsem[0]) != procp[3])
+		adderrbuf("removeBlocked(): removed wrong element   ");
+	for (i = 0; i < MAXPROC; i++) {
+		if (i != 3 && removeBlocked(&sem[i]) != procp[i])
+			adderrbuf("removeBlocked(): removed wrong element   ");
+		freePcb(procp[i]);
+	}
+	addokbuf("outBlocked() ok   \n");
+}
+
+
+/* Check concatProcQ(), leaveProcQ() and removeAllBlocked() */
+void testBroadcast(void) {
+	int i;
+	pcb_t *readyq = mkEmptyProcQ(), *other = mkEmptyProcQ();
+
+	for (i = 0; i < 8; i++)
+		procp[i] = allocPcb();
+	insertProcQ(&readyq, procp[0]);
+	insertProcQ(&readyq, procp[1]);
+	for (i = 2; i < 8; i++)
+		if (insertBlocked(&devsem[0], procp[i]))
+			adderrbuf("insertBlocked(): unexpected TRUE   ");
+
+	tp = mkEmptyProcQ();
+	if (removeAllBlocked(&devsem[0], &tp) != 6 || headBlocked(&devsem[0]) != NULL)
+		adderrbuf("removeAllBlocked(): semaphore still has waiters   ");
+	if (headProcQ(tp) != procp[2])
+		adderrbuf("removeAllBlocked(): wrong queue returned   ");
+	if (outBlocked(procp[5]) != NULL)
+		adderrbuf("outBlocked(): removed a process woken by removeAllBlocked()   ");
+	if (removeAllBlocked(&devsem[0], &readyq) != 0 || headProcQ(readyq) != procp[0])
+		adderrbuf("removeAllBlocked(): moved processes of an inactive semaphore   ");
+
+	concatProcQ(&readyq, &tp);
+	if (!emptyProcQ(tp))
+		adderrbuf("concatProcQ(): source queue not emptied   ");
+	concatProcQ(&readyq, &tp);
+	for (i = 0; i < 8; i++)
+		if (removeProcQ(&readyq) != procp[i])
+			adderrbuf("concatProcQ(): wrong order   ");
+	if (!emptyProcQ(readyq))
+		adderrbuf("concatProcQ(): too many entries   ");
+
+	/* only tails know their queue: the splices hand that over */
+	for (i = 0; i < 7; i++)
+		insertProcQ(i < 4 ? &readyq : &tp, procp[i]);
+	insertProcQ(&other, procp[7]);
+	concatProcQ(&readyq, &tp);
+	if (outProcQ(&other, procp[6]) != NULL || outProcQ(&other, procp[0]) != NULL
+	    || outProcQ(&readyq, procp[6]) != procp[6] || outProcQ(&other, procp[5]) != NULL)
+		adderrbuf("outProcQ(): wrong owner after concatProcQ()   ");
+	if (splitProcQ(&other, &readyq, 2) != 2 || outProcQ(&readyq, procp[1]) != NULL)
+		adderrbuf("outProcQ(): wrong owner after splitProcQ()   ");
+	if (leaveProcQ(procp[1]) != procp[1] || leaveProcQ(procp[3]) != procp[3]
+	    || leaveProcQ(procp[3]) != NULL)
+		adderrbuf("leaveProcQ(): failed   ");
+	if (removeProcQ(&other) != procp[7] || removeProcQ(&other) != procp[0] || !emptyProcQ(other)
+	    || removeProcQ(&readyq) != procp[2] || removeProcQ(&readyq) != procp[4]
+	    || removeProcQ(&readyq) != procp[5] || !emptyProcQ(readyq))
+		adderrbuf("leaveProcQ(): queues corrupted   ");
+
+	/* the queue and the descriptor can be used again */
+	concatProcQ(&tp, &readyq);
+	insertProcQ(&readyq, procp[0]);
+	concatProcQ(&tp, &readyq);
+	if (headProcQ(tp) != procp[0] || removeProcQ(&tp) != procp[0] || !emptyProcQ(tp))
+		adderrbuf("concatProcQ(): onto empty queue failed   ");
+	if (insertBlocked(&devsem[0], procp[5]) || outBlocked(procp[5]) != procp[5])
+		adderrbuf("outBlocked(): failed on a reused descriptor   ");
+	for (i = 0; i < 8; i++)
+		freePcb(procp[i]);
+	addokbuf("concatProcQ() and removeAllBlocked() ok   \n");
+}
+
+
+/* Check child order and removal at either end of the siblings */
+void testTree(void) {
+	int i;
+
+	for (i = 0; i < 8; i++)
+		procp[i] = allocPcb();
+	for (i = 2; i < 6; i++)
+		insertChild(procp[0], procp[i]);	/* 2 3 4 5 */
+	insertChildHead(procp[0], procp[1]);		/* 1 2 3 4 5 */
+	insertChild(procp[0], procp[6]);		/* 1 2 3 4 5 6 */
+
+	if (outChild(procp[6]) != procp[6] || outChild(procp[6]) != NULL)
+		adderrbuf("outChild(): failed on last child   ");
+	if (outChild(procp[3]) != procp[3] || outChild(procp[1]) != procp[1])
+		adderrbuf("outChild(): failed on middle or first child   ");
+	insertChild(procp[0], procp[7]);		/* 2 4 5 7 */
+	insertChildHead(procp[0], procp[3]);		/* 3 2 4 5 7 */
+	if (outChild(procp[7]) != procp[7])
+		adderrbuf("outChild(): failed on appended child   ");
+	insertChild(procp[0], procp[6]);		/* 3 2 4 5 6 */
+
+	if (removeChild(procp[0]) != procp[3] || removeChild(procp[0]) != procp[2] ||
+		removeChild(procp[0]) != procp[4] || removeChild(procp[0]) != procp[5] ||
+		removeChild(procp[0]) != procp[6])
+		adderrbuf("removeChild(): children out of order   ");
+	if (removeChild(procp[0]) != NULL || !emptyChild(procp[0]))
+		adderrbuf("removeChild(): removes too many children   ");
+	if (outChild(procp[2]) != NULL)
+		adderrbuf("outChild(): removed child still has a parent   ");
+	for (i = 0; i < 8; i++)
+		freePcb(procp[i]);
+	addokbuf("insertChildHead() and outChild() ok   \n");
+}
+
+
+/* Check priority-ordered semaphore queues and priority inheritance */
+void testPrio(void) {
+	int i;
+	static int prio[8] = { 5, 3, 5, 1, 3, 0, 7, 3 };
+	static int order[8] = { 5, 3, 1, 4, 7, 0, 2, 6 };	/* by priority, then arrival */
+
+	for (i = 0; i < 10; i++)
+		procp[i] = allocPcb();
+	for (i = 0; i < 8; i++) {
+		setPrio(procp[i], prio[i]);
+		if (insertBlockedPrio(&devsem[0], procp[i]))
+			adderrbuf("insertBlockedPrio(): unexpected TRUE   ");
+	}
+	if (headBlocked(&devsem[0]) != procp[5])
+		adderrbuf("headBlocked(): not the highest priority   ");
+	for (i = 0; i < 8; i++)
+		if (removeBlocked(&devsem[0]) != procp[order[i]])
+			adderrbuf("removeBlocked(): wrong priority order   ");
+	if (headBlocked(&devsem[0]) != NULL)
+		adderrbuf("removeBlocked(): semaphore still active   ");
+
+	/* removal from the middle, and priorities changed while waiting */
+	for (i = 0; i < 8; i++)
+		insertBlockedPrio(&devsem[0], procp[i]);
+	if (outBlocked(procp[4]) != procp[4] || outBlocked(procp[4]) != NULL)
+		adderrbuf("outBlocked(): failed on a priority queue   ");
+	setPrio(procp[6], 0);		/* 5 6 3 1 7 0 2 */
+	setPrio(procp[5], 9);		/* 6 3 1 7 0 2 5 */
+	if (removeBlocked(&devsem[0]) != procp[6] || removeBlocked(&devsem[0]) != procp[3])
+		adderrbuf("setPrio(): waiter not moved   ");
+	tp = mkEmptyProcQ();
+	removeAllBlocked(&devsem[0], &tp);
+	if (removeProcQ(&tp) != procp[1] || removeProcQ(&tp) != procp[7] ||
+		removeProcQ(&tp) != procp[0] || removeProcQ(&tp) != procp[2] ||
+		removeProcQ(&tp) != procp[5] || !emptyProcQ(tp))
+		adderrbuf("removeAllBlocked(): wrong priority order   ");
+
+	/* procp[8] holds devsem[0] and waits on devsem[1] behind procp[9] */
+	setPrio(procp[8], 6);
+	setPrio(procp[9], 4);
+	setPrio(procp[0], 2);
+	insertBlockedPrio(&devsem[1], procp[9]);
+	insertBlockedPrio(&devsem[1], procp[8]);
+	insertBlockedPrio(&devsem[0], procp[0]);
+	if (boostPrio(procp[8], &devsem[0]) != 2 || headBlocked(&devsem[1]) != procp[8])
+		adderrbuf("boostPrio(): holder not boosted   ");
+	if (boostPrio(procp[9], &devsem[2]) != 4)
+		adderrbuf("boostPrio(): boosted for an inactive semaphore   ");
+	restorePrio(procp[8]);
+	if (procp[8]->p_eprio != 6 || headBlocked(&devsem[1]) != procp[9])
+		adderrbuf("restorePrio(): priority not restored   ");
+	if (removeBlocked(&devsem[1]) != procp[9] || removeBlocked(&devsem[1]) != procp[8] ||
+		removeBlocked(&devsem[0]) != procp[0])
+		adderrbuf("removeBlocked(): wrong priority order   ");
+	for (i = 0; i < 10; i++)
+		freePcb(procp[i]);
+	addokbuf("priority-ordered semaphores ok   \n");
+}
+
+
+/* Check the timing wheel and timed semaphore waits */
+void testWheel(void) {
+	int i, n;
+	unsigned int t, woke[9];
+	static wheel_t w;
+	pcb_t *expired = mkEmptyProcQ();
+
+	initWheel(&w);
+	for (i = 0; i < 9; i++) {
+		procp[i] = allocPcb();
+		woke[i] = 0;
+	}
+	insertWheel(&w, procp[0], 1);
+	insertWheel(&w, procp[1], 70);		/* cascaded once */
+	insertWheel(&w, procp[2], 5000);	/* cascaded twice */
+	if (insertBlockedTimed(&devsem[0], procp[3], &w, 100) ||
+		insertBlockedTimed(&devsem[0], procp[4], &w, 200) ||
+		insertBlockedTimed(&devsem[1], procp[5], &w, 50) ||
+		insertBlockedTimed(&devsem[2], procp[6], &w, 10) ||
+		insertBlockedTimed(&devsem[2], procp[7], &w, 10))
+		adderrbuf("insertBlockedTimed(): unexpected TRUE   ");
+	insertWheel(&w, procp[8], 80);
+
+	/* waking or cancelling first disarms the timer */
+	if (removeBlocked(&devsem[1]) != procp[5] || outWheel(procp[5]) != NULL)
+		adderrbuf("removeBlocked(): timeout not cancelled   ");
+	tp = mkEmptyProcQ();
+	removeAllBlocked(&devsem[2], &tp);
+	if (outWheel(procp[6]) != NULL || outWheel(procp[7]) != NULL)
+		adderrbuf("removeAllBlocked(): timeouts not cancelled   ");
+	tp = mkEmptyProcQ();
+	if (outWheel(procp[8]) != procp[8] || outWheel(procp[8]) != NULL)
+		adderrbuf("outWheel(): failed   ");
+
+	for (t = 1, n = 0; t <= 6000; t++) {
+		n += tickWheel(&w, &expired);
+		while ((q = removeProcQ(&expired)) != NULL)
+			for (i = 0; i < 9; i++)
+				if (q == procp[i])
+					woke[i] = t;
+		if (t == 100 && headBlocked(&devsem[0]) != procp[4])
+			adderrbuf("tickWheel(): timed out the wrong waiter   ");
+	}
+	if (n != 5)
+		adderrbuf("tickWheel(): wrong number of expiries   ");
+	if (woke[0] != 1 || woke[1] != 70 || woke[2] != 5000 || woke[3] != 100 || woke[4] != 200)
+		adderrbuf("tickWheel(): timer expired at the wrong tick   ");
+	if (woke[5] != 0 || woke[6] != 0 || woke[7] != 0 || woke[8] != 0)
+		adderrbuf("tickWheel(): cancelled timer expired   ");
+	if (headBlocked(&devsem[0]) != NULL || outBlocked(procp[4]) != NULL)
+		adderrbuf("tickWheel(): timed out process still blocked   ");
+	for (i = 0; i < 9; i++)
+		freePcb(procp[i]);
+	addokbuf("timing wheel ok   \n");
+}
+
+
+/* Check terminateSubtree() on a subtree spread over queues, ASL and timers */
+void testTerminate(void) {
+	int i;
+	static wheel_t w;
+	mlfq_t mq;
+	ksem_t ks;
+	pcb_t *readyq = mkEmptyProcQ(), *expired = mkEmptyProcQ();
+
+	initWheel(&w);
+	for (i = 0; i < 10; i++)
+		procp[i] = allocPcb();
+	/* 0 -> 1 -> {2, 3 -> {5, 6 -> 7}, 4}; 0, 8 and 9 survive */
+	insertChild(procp[0], procp[1]);
+	insertChild(procp[1], procp[2]);
+	insertChild(procp[1], procp[3]);
+	insertChild(procp[1], procp[4]);
+	insertChild(procp[3], procp[5]);
+	insertChild(procp[3], procp[6]);
+	insertChild(procp[6], procp[7]);
+	insertProcQ(&readyq, procp[1]);
+	insertProcQ(&readyq, procp[9]);
+	insertProcQ(&readyq, procp[3]);
+	if (insertBlocked(&devsem[0], procp[2]) || insertBlocked(&devsem[0], procp[8]) ||
+		insertBlockedTimed(&devsem[1], procp[5], &w, 10))
+		adderrbuf("insertBlocked(): unexpected TRUE   ");
+	insertWheel(&w, procp[7], 20);
+
+	if (terminateSubtree(procp[1]) != 7)
+		adderrbuf("terminateSubtree(): wrong count   ");
+	if (pcbUsedCount() != 3 || !emptyChild(procp[0]))
+		adderrbuf("terminateSubtree(): subtree not freed   ");
+	if (headBlocked(&devsem[0]) != procp[8] || headBlocked(&devsem[1]) != NULL)
+		adderrbuf("terminateSubtree(): left a process blocked   ");
+	if (removeProcQ(&readyq) != procp[9] || !emptyProcQ(readyq))
+		adderrbuf("terminateSubtree(): left a process ready   ");
+	for (i = 0; i < 30; i++)
+		if (tickWheel(&w, &expired) != 0)
+			adderrbuf("terminateSubtree(): left a timer armed   ");
+	if (terminateSubtree(procp[8]) != 1 || headBlocked(&devsem[0]) != NULL)
+		adderrbuf("terminateSubtree(): failed on a single blocked process   ");
+	freePcb(procp[0]);
+	freePcb(procp[9]);
+
+	/* 0 -> {1 -> {2, 3}, 4}: ready on MLFQ levels, a run queue and a private queue */
+	initMlfq(&mq);
+	initRunQs();
+	tp = mkEmptyProcQ();
+	for (i = 0; i < 6; i++)
+		procp[i] = allocPcb();
+	insertChild(procp[0], procp[1]);
+	insertChild(procp[1], procp[2]);
+	insertChild(procp[1], procp[3]);
+	insertChild(procp[0], procp[4]);
+	PCBHOT(procp[1], p_level) = 0;
+	PCBHOT(procp[2], p_level) = 2;
+	PCBHOT(procp[5], p_level) = 2;
+	insertMlfq(&mq, procp[1]);
+	insertMlfq(&mq, procp[2]);
+	insertMlfq(&mq, procp[5]);
+	insertRunQ(1, procp[3]);
+	insertProcQ(&tp, procp[4]);
+	if (terminateSubtree(procp[0]) != 5 || pcbUsedCount() != 1)
+		adderrbuf("terminateSubtree(): wrong count   ");
+	if (runQCount(1) != 0 || removeRunQ(1) != NULL || !emptyProcQ(tp))
+		adderrbuf("terminateSubtree(): left a process on a run queue   ");
+	if (headMlfq(&mq) != procp[5] || removeMlfq(&mq) != procp[5] || !emptyMlfq(&mq))
+		adderrbuf("terminateSubtree(): left a process on an MLFQ   ");
+	freePcb(procp[5]);
+
+	/* woken by broadcasts, then terminated: the semaphores that took over
+	 * the descriptor and the ksem_t keep their waiters */
+	tp = mkEmptyProcQ();
+	for (i = 0; i < 6; i++)
+		procp[i] = allocPcb();
+	for (i = 0; i < 3; i++)
+		insertBlocked(&devsem[0], procp[i]);
+	if (removeAllBlocked(&devsem[0], &tp) != 3 || insertBlocked(&devsem[2], procp[3]))
+		adderrbuf("removeAllBlocked(): failed   ");
+	initKsem(&ks, 0);
+	passerenKsem(&ks, procp[4]);
+	if (broadcastKsem(&ks, &tp) != 1 || !passerenKsem(&ks, procp[5]))
+		adderrbuf("broadcastKsem(): failed   ");
+	if (terminateSubtree(procp[2]) != 1 || terminateSubtree(procp[4]) != 1
+	    || terminateSubtree(procp[0]) != 1)
+		adderrbuf("terminateSubtree(): failed on a woken process   ");
+	if (removeProcQ(&tp) != procp[1] || !emptyProcQ(tp))
+		adderrbuf("terminateSubtree(): left a woken process queued   ");
+	if (removeBlocked(&devsem[2]) != procp[3] || ks.ks_value != -1 || verhogenKsem(&ks) != procp[5])
+		adderrbuf("terminateSubtree(): took a waiter off a reused semaphore   ");
+	freePcb(procp[1]);
+	freePcb(procp[3]);
+	freePcb(procp[5]);
+	addokbuf("terminateSubtree() ok   \n");
+}
+
+
+/* Check the multi-level feedback queue */
+void testMlfq(void) {
+	int i;
+	mlfq_t mq;
+
+	initMlfq(&mq);
+	if (!emptyMlfq(&mq) || headMlfq(&mq) != NULL || removeMlfq(&mq) != NULL)
+		adderrbuf("initMlfq(): queue not empty   ");
+	for (i = 0; i < 6; i++) {
+		procp[i] = allocPcb();
+		PCBHOT(procp[i], p_level) = (5 - i) % 3 * 3;	/* levels 6, 3, 0, 6, 3, 0 */
+		insertMlfq(&mq, procp[i]);
+	}
+	if (headMlfq(&mq) != procp[2])
+		adderrbuf("headMlfq(): wrong process returned   ");
+	if (outMlfq(&mq, procp[5]) != procp[5] || outMlfq(&mq, procp[5]) != NULL)
+		adderrbuf("outMlfq(): failed   ");
+	if (removeMlfq(&mq) != procp[2] || removeMlfq(&mq) != procp[1])
+		adderrbuf("removeMlfq(): wrong priority order   ");
+
+	/* procp[2] runs through its quantum and is demoted below procp[4] */
+	for (i = 1; i < MLFQ_QUANTUM(0); i++)
+		if (chargeMlfq(procp[2], 1))
+			adderrbuf("chargeMlfq(): demoted too early   ");
+	if (!chargeMlfq(procp[2], 1) || PCBHOT(procp[2], p_level) != 1 || PCBHOT(procp[2], p_ticks) != 0)
+		adderrbuf("chargeMlfq(): quantum expiry not detected   ");
+	PCBHOT(procp[2], p_level) = 4;
+	insertMlfq(&mq, procp[2]);
+	if (removeMlfq(&mq) != procp[4] || removeMlfq(&mq) != procp[2])
+		adderrbuf("removeMlfq(): demoted process not queued lower   ");
+
+	procp[MAXPROC - 1] = allocPcb();
+	PCBHOT(procp[MAXPROC - 1], p_level) = MLFQLEVELS - 1;
+	if (!chargeMlfq(procp[MAXPROC - 1], MLFQ_QUANTUM(MLFQLEVELS - 1))
+	    || PCBHOT(procp[MAXPROC - 1], p_level) != MLFQLEVELS - 1)
+		adderrbuf("chargeMlfq(): demoted below the lowest level   ");
+	insertMlfq(&mq, procp[MAXPROC - 1]);
+
+	insertMlfq(&mq, procp[5]);
+	boostMlfq(&mq);
+	if (removeMlfq(&mq) != procp[5] || removeMlfq(&mq) != procp[0]
+	    || removeMlfq(&mq) != procp[3] || removeMlfq(&mq) != procp[MAXPROC - 1])
+		adderrbuf("boostMlfq(): wrong order   ");
+	if (!emptyMlfq(&mq) || PCBHOT(procp[3], p_level) != 0)
+		adderrbuf("boostMlfq(): levels not reset   ");
+	for (i = 0; i < 6; i++)
+		freePcb(procp[i]);
+	freePcb(procp[MAXPROC - 1]);
+	addokbuf("MLFQ ok   \n");
+}
+
+
+/* Check splitProcQ() and stealing between run queues */
+void testRunQ(void) {
+	int i;
+	pcb_t *sq = mkEmptyProcQ(), *eq = mkEmptyProcQ();
+
+	tp = mkEmptyProcQ();
+	for (i = 0; i < 6; i++) {
+		procp[i] = allocPcb();
+		insertProcQ(&sq, procp[i]);
+	}
+	if (splitProcQ(&tp, &sq, 0) != 0 || splitProcQ(&tp, &eq, 3) != 0 || !emptyProcQ(tp))
+		adderrbuf("splitProcQ(): moved from nothing   ");
+	if (splitProcQ(&tp, &sq, 2) != 2 || headProcQ(tp) != procp[0] || tp != procp[1]
+	    || headProcQ(sq) != procp[2])
+		adderrbuf("splitProcQ(): wrong cut   ");
+	if (splitProcQ(&tp, &sq, 1) != 1 || tp != procp[2])
+		adderrbuf("splitProcQ(): not appended   ");
+	if (splitProcQ(&tp, &sq, 9) != 3 || !emptyProcQ(sq))
+		adderrbuf("splitProcQ(): whole queue not moved   ");
+	for (i = 0; i < 6; i++)
+		if (removeProcQ(&tp) != procp[i])
+			adderrbuf("splitProcQ(): order not kept   ");
+
+	initRunQs();
+	for (i = 0; i < 5; i++)
+		insertRunQ(1, procp[i]);
+	insertRunQ(MAXCPU - 1, procp[5]);
+	if (stealRunQ(1) != 1 || runQCount(1) != 6 || runQCount(MAXCPU - 1) != 0)
+		adderrbuf("stealRunQ(): wrong victim   ");
+	if (removeRunQ(0) != procp[0] || procp[0]->p_cpu != 0 || runQCount(0) != 2
+	    || runQCount(1) != 3)
+		adderrbuf("removeRunQ(): did not steal half   ");
+	if (removeRunQ(1) != procp[3] || outRunQ(1, procp[5]) != procp[5]
+	    || outRunQ(1, procp[5]) != NULL)
+		adderrbuf("outRunQ(): failed   ");
+	insertRunQ(0, procp[5]);
+	if (removeRunQ(0) != procp[1] || removeRunQ(0) != procp[2] || removeRunQ(0) != procp[5]
+	    || removeRunQ(0) != procp[4] || procp[4]->p_cpu != 0)
+		adderrbuf("removeRunQ(): wrong order   ");
+	if (removeRunQ(0) != NULL || stealRunQ(2) != 0)
+		adderrbuf("removeRunQ(): queues not empty   ");
+	for (i = 0; i < 6; i++)
+		freePcb(procp[i]);
+	addokbuf("splitProcQ() and run queues ok   \n");
+}
+
+
+/* Check CPU time accounting through tree changes and exits */
+void testCpuTime(void) {
+	int i;
+
+	for (i = 0; i < 6; i++)
+		procp[i] = allocPcb();
+	insertChild(procp[0], procp[1]);	/* 0 -> 1 -> 2, 0 -> 3 */
+	insertChild(procp[1], procp[2]);
+	insertChild(procp[0], procp[3]);
+	chargeTime(procp[0], 1);
+	chargeTime(procp[1], 10);
+	chargeTime(procp[2], 100);
+	chargeTime(procp[3], 1000);
+	chargeTime(procp[2], 100);
+	if (cpuTime(procp[2]) != 200 || subtreeTime(procp[2]) != 200 || subtreeTime(procp[1]) != 210
+	    || subtreeTime(procp[3]) != 1000 || subtreeTime(procp[0]) != 1211)
+		adderrbuf("chargeTime(): wrong subtree times   ");
+
+	/* moving a subtree moves its time */
+	if (outChild(procp[1]) != procp[1] || subtreeTime(procp[0]) != 1001)
+		adderrbuf("outChild(): subtree time not taken away   ");
+	insertChildHead(procp[3], procp[1]);	/* 0 -> 3 -> 1 -> 2 */
+	if (subtreeTime(procp[3]) != 1210 || subtreeTime(procp[0]) != 1211)
+		adderrbuf("insertChildHead(): subtree time not added   ");
+	insertChild(procp[2], procp[4]);
+	chargeTime(procp[4], 10000);
+	if (subtreeTime(procp[1]) != 10210 || subtreeTime(procp[0]) != 11211)
+		adderrbuf("chargeTime(): deep charge not propagated   ");
+	if (removeChild(procp[3]) != procp[1] || subtreeTime(procp[3]) != 1000
+	    || subtreeTime(procp[0]) != 1001)
+		adderrbuf("removeChild(): subtree time not taken away   ");
+	insertChild(procp[3], procp[1]);
+
+	/* exiting processes stay billed to their ancestors */
+	if (reapChild(procp[4]) != procp[4] || subtreeTime(procp[2]) != 10200
+	    || subtreeTime(procp[0]) != 11211)
+		adderrbuf("reapChild(): time of the exited process lost   ");
+	freePcb(procp[4]);
+	insertChild(procp[2], procp[5]);	/* no time yet */
+	if (terminateSubtree(procp[1]) != 3)
+		adderrbuf("terminateSubtree(): wrong count   ");
+	if (subtreeTime(procp[3]) != 11210 || subtreeTime(procp[0]) != 11211 || cpuTime(procp[3]) != 1000)
+		adderrbuf("terminateSubtree(): time of the exited processes lost   ");
+	if (terminateSubtree(procp[0]) != 2)
+		adderrbuf("terminateSubtree(): wrong count   ");
+	addokbuf("CPU time accounting ok   \n");
+}
+
+
+/* Check process identifiers */
+void testPid(void) {
+	int i, j;
+	kpid_t pid[4], stale;
+
+	for (i = 0; i < 4; i++) {
+		procp[i] = allocPcb();
+		pid[i] = pcbPid(procp[i]);
+		if (pid[i] == PIDNONE || pidPcb(pid[i]) != procp[i])
+			adderrbuf("pidPcb(): live process not found   ");
+		for (j = 0; j < i; j++)
+			if (pid[j] == pid[i])
+				adderrbuf("assignPid(): identifier given twice   ");
+	}
+	stale = pid[2];
+	freePcb(procp[2]);
+	if (pidPcb(stale) != NULL)
+		adderrbuf("pidPcb(): freed process found   ");
+	if ((q = allocPcb()) != procp[2])	/* the pcbFree list is LIFO */
+		adderrbuf("allocPcb(): freed ProcBlk not recycled   ");
+	if (pidPcb(stale) != NULL || pcbPid(q) == stale || pidPcb(pcbPid(q)) != q)
+		adderrbuf("pidPcb(): stale identifier names the new process   ");
+	if (pidPcb(PIDNONE) != NULL || pidPcb(pid[0] ^ (1u << PIDSLOTBITS)) != NULL
+	    || pidPcb(PIDSLOTMASK) != NULL)
+		adderrbuf("pidPcb(): bogus identifier accepted   ");
+	if (pidPcb(pid[3]) != procp[3])
+		adderrbuf("pidPcb(): other processes disturbed   ");
+	for (i = 0; i < 4; i++) {
+		freePcb(procp[i]);
+		if (pidPcb(pcbPid(procp[i])) != NULL)
+			adderrbuf("releasePid(): identifier still valid   ");
+	}
+	addokbuf("process identifiers ok   \n");
+}
+
+
+/* Check growing the ProcBlk and descriptor pools */
+void testGrow(void) {
+	int i, n, m;
+	static double pcbmem[64 * sizeof(pcb_t) / sizeof(double)];
+	static double semdmem[64];
+	static int moresem[2 * MAXPROC];
+	static pcb_t *pcbs[MAXPROC + 64];
+	static char seen[MAXPROC + 64];
+
+	if (pcbFreeCount() != MAXPROC || pcbUsedCount() != 0)
+		adderrbuf("pcbFreeCount(): wrong count   ");
+	if (growPcbs(pcbmem, 8) != 0)
+		adderrbuf("growPcbs(): slab carved from a tiny region   ");
+	for (i = 0; i < (int) (sizeof(pcbmem) / sizeof(double)); i++)
+		pcbmem[i] = 1.5;
+	n = growPcbs(pcbmem, sizeof(pcbmem));
+	for (i = 8; i < (int) (sizeof(pcbmem) / sizeof(double)); i++)	/* past the slab header */
+		if (pcbmem[i] != 1.5)
+			adderrbuf("growPcbs(): ProcBlks touched before being allocated   ");
+#ifndef PCB_COMPACT
+	if (n < 32 || n >= 64 || pcbFreeCount() != MAXPROC + n)
+#else
+	if (n != 0 || pcbFreeCount() != MAXPROC)	/* only pcbTable is usable */
+#endif
+		adderrbuf("growPcbs(): wrong number of ProcBlks added   ");
+	for (i = 0; i < MAXPROC + n; i++)
+		if ((pcbs[i] = allocPcb()) == NULL)
+			adderrbuf("allocPcb(): grown pool exhausted early   ");
+	if (allocPcb() != NULL || pcbFreeCount() != 0 || pcbUsedCount() != MAXPROC + n)
+		adderrbuf("allocPcb(): allocated past the grown pool   ");
+	for (i = 0; i < MAXPROC + n; i++)
+		seen[i] = 0;
+	for (i = 0; i < MAXPROC + n; i++) {
+		m = pcbIndex(pcbs[i]);
+		if (m < 0 || m >= MAXPROC + n || seen[m]++)
+			adderrbuf("pcbIndex(): indices not 0 to the pool size   ");
+	}
+
+	if (semdFreeCount() != MAXPROC || semdUsedCount() != 0)
+		adderrbuf("semdFreeCount(): wrong count   ");
+	m = growSemds(semdmem, sizeof(semdmem));
+#ifndef ASL_SORTED
+	if (m <= 0 || m > MAXPROC || semdFreeCount() != MAXPROC + m)
+#else
+	if (m != 0 || semdFreeCount() != MAXPROC)	/* the sorted array does not grow */
+#endif
+		adderrbuf("growSemds(): wrong number of descriptors added   ");
+	for (i = 0; i < MAXPROC + n && i < 2 * MAXPROC; i++)
+		if (insertBlocked(&moresem[i], pcbs[i]))
+			break;
+	if (i != MAXPROC + (m < n ? m : n))
+		adderrbuf("insertBlocked(): grown descriptors not used   ");
+	if (semdUsedCount() != i)
+		adderrbuf("semdUsedCount(): wrong count   ");
+	if (removeBlockedRange(&moresem[0], &moresem[2 * MAXPROC], &tp) != i)
+		adderrbuf("removeBlockedRange(): wrong count   ");
+	tp = mkEmptyProcQ();
+	for (i = 0; i < MAXPROC + n; i++)
+		freePcb(pcbs[i]);
+	if (pcbUsedCount() != 0 || semdUsedCount() != 0)
+		adderrbuf("pcbUsedCount(): objects not returned   ");
+	addokbuf("growPcbs() and growSemds() ok   \n");
+}
+
+
+/* Check direct-indexed semaphore arrays */
+void testDirect(void) {
+	int i, freeCount = semdFreeCount();
+	kstats_t before, after;
+
+	procp[0] = allocPcb();
+	if (insertBlocked(&sem[0], procp[0]))
+		adderrbuf("insertBlocked(): unexpected TRUE   ");
+	if (!registerSemds(&sem[0], 2))
+		adderrbuf("registerSemds(): registered an active semaphore   ");
+	removeBlocked(&sem[0]);
+	if (registerSemds(dirsem, 9))
+		adderrbuf("registerSemds(): unexpected TRUE   ");
+	if (!registerSemds(&dirsem[8], 1) || !registerSemds(&dirsem[8], 2))
+		adderrbuf("registerSemds(): registered an overlapping array   ");
+	if (!registerSemds(sem, DIRECTSEMDS) || !registerSemds(sem, 0))
+		adderrbuf("registerSemds(): registered too many semaphores   ");
+
+	getStats(&before);
+	for (i = 1; i < 8; i++) {
+		procp[i] = allocPcb();
+		if (insertBlocked(&dirsem[i & 3], procp[i]))
+			adderrbuf("insertBlocked(): failed on a direct semaphore   ");
+	}
+	if (insertBlocked(&dirsem[8], procp[0]))
+		adderrbuf("insertBlocked(): failed on a direct semaphore   ");
+	if (semdFreeCount() != freeCount || semdUsedCount() != 0)
+		adderrbuf("insertBlocked(): direct semaphore used the semdFree list   ");
+	if (headBlocked(&dirsem[0]) != procp[4] || headBlocked(&dirsem[1]) != procp[1])
+		adderrbuf("headBlocked(): wrong head of a direct semaphore   ");
+	if (removeBlocked(&dirsem[1]) != procp[1] || removeBlocked(&dirsem[1]) != procp[5]
+	    || removeBlocked(&dirsem[1]) != NULL || headBlocked(&dirsem[1]) != NULL)
+		adderrbuf("removeBlocked(): wrong process from a direct semaphore   ");
+	if (outBlocked(procp[6]) != procp[6] || outBlocked(procp[6]) != NULL
+	    || removeBlocked(&dirsem[2]) != procp[2] || removeBlocked(&dirsem[2]) != NULL)
+		adderrbuf("outBlocked(): failed on a direct semaphore   ");
+	tp = mkEmptyProcQ();
+	removeAllBlocked(&dirsem[3], &tp);
+	if (removeProcQ(&tp) != procp[3] || removeProcQ(&tp) != procp[7] || !emptyProcQ(tp))
+		adderrbuf("removeAllBlocked(): wrong queue from a direct semaphore   ");
+	if (outBlocked(procp[7]) != NULL || removeAllBlocked(&dirsem[3], &tp) != 0)
+		adderrbuf("removeAllBlocked(): direct semaphore still active   ");
+
+	/* a direct semaphore can still be priority-ordered */
+	PCBHOT(procp[1], p_level) = 0;
+	setPrio(procp[1], 3);
+	setPrio(procp[2], 1);
+	if (insertBlockedPrio(&dirsem[1], procp[1]) || insertBlocked(&dirsem[1], procp[2]))
+		adderrbuf("insertBlockedPrio(): failed on a direct semaphore   ");
+	if (removeBlocked(&dirsem[1]) != procp[2])
+		adderrbuf("insertBlockedPrio(): direct semaphore not ordered   ");
+	setPrio(procp[1], 0);
+	setPrio(procp[2], 0);
+
+	tp = mkEmptyProcQ();
+	if (removeBlockedRange(&dirsem[0], &dirsem[9], &tp) != 3 || headBlocked(&dirsem[8]) != NULL)
+		adderrbuf("removeBlockedRange(): missed direct semaphores   ");
+	if (removeProcQ(&tp) != procp[4] || removeProcQ(&tp) != procp[1] || removeProcQ(&tp) != procp[0])
+		adderrbuf("removeBlockedRange(): wrong order   ");
+	getStats(&after);
+	if (after.st_aslLookups != before.st_aslLookups || semdUsedCount() != 0)
+		adderrbuf("registerSemds(): direct semaphores looked up in the ASL   ");
+	for (i = 0; i < 8; i++)
+		freePcb(procp[i]);
+	addokbuf("registerSemds() ok   \n");
+}
+
+
+/* Check passeren() and verhogen() */
+void testPV(void) {
+	int mutex = 1, i;
+	kstats_t before, after;
+
+	for (i = 0; i < 4; i++)
+		procp[i] = allocPcb();
+	getStats(&before);
+	for (i = 0; i < 10; i++)
+		if (passeren(&mutex, procp[0]) || verhogen(&mutex) != NULL)
+			adderrbuf("passeren(): uncontended semaphore blocked   ");
+	getStats(&after);
+	if (after.st_aslLookups != before.st_aslLookups || mutex != 1 || semdUsedCount() != 0)
+		adderrbuf("passeren(): uncontended semaphore looked up in the ASL   ");
+#ifdef KAYA_STATS
+	if (after.st_semFast != before.st_semFast + 20)
+		adderrbuf("passeren(): fast paths not counted   ");
+#endif
+
+	if (passeren(&mutex, procp[0]))
+		adderrbuf("passeren(): blocked on a free mutex   ");
+	for (i = 1; i < 4; i++)
+		if (!passeren(&mutex, procp[i]))
+			adderrbuf("passeren(): did not block on a held mutex   ");
+	if (mutex != -3 || headBlocked(&mutex) != procp[1])
+		adderrbuf("passeren(): wrong count or queue   ");
+	for (i = 1; i < 4; i++)
+		if (verhogen(&mutex) != procp[i] || procp[i]->p_semd != NULL)
+			adderrbuf("verhogen(): wrong process woken   ");
+	if (mutex != 0 || headBlocked(&mutex) != NULL || semdUsedCount() != 0)
+		adderrbuf("verhogen(): semaphore still active   ");
+	if (verhogen(&mutex) != NULL || mutex != 1)
+		adderrbuf("verhogen(): woke a process from a free mutex   ");
+
+	/* a direct semaphore, as a device's would be */
+	dirsem[9] = 0;
+	if (registerSemds(&dirsem[9], 1) || !passeren(&dirsem[9], procp[1]))
+		adderrbuf("passeren(): did not block on a direct semaphore   ");
+	if (semdUsedCount() != 0 || verhogen(&dirsem[9]) != procp[1] || dirsem[9] != 0)
+		adderrbuf("verhogen(): failed on a direct semaphore   ");
+	for (i = 0; i < 4; i++)
+		freePcb(procp[i]);
+	addokbuf("passeren() and verhogen() ok   \n");
+}
+
+
+/* Check kernel semaphore objects */
+void testKsem(void) {
+	ksem_t ks;
+	int i, freeCount = semdFreeCount();
+	kstats_t before, after;
+
+	for (i = 0; i < 4; i++)
+		procp[i] = allocPcb();
+	getStats(&before);
+	initKsem(&ks, 1);
+	if (passerenKsem(&ks, procp[0]) || verhogenKsem(&ks) != NULL || ks.ks_value != 1)
+		adderrbuf("passerenKsem(): uncontended semaphore blocked   ");
+	if (passerenKsem(&ks, procp[0]))
+		adderrbuf("passerenKsem(): blocked on a free semaphore   ");
+	for (i = 1; i < 4; i++)
+		if (!passerenKsem(&ks, procp[i]) || procp[i]->p_ksem != &ks)
+			adderrbuf("passerenKsem(): did not block   ");
+	if (ks.ks_value != -3 || headProcQ(ks.ks_procQ) != procp[1])
+		adderrbuf("passerenKsem(): wrong value or queue   ");
+	if (semdUsedCount() != 0 || semdFreeCount() != freeCount)
+		adderrbuf("passerenKsem(): used a semaphore descriptor   ");
+	if (verhogenKsem(&ks) != procp[1] || procp[1]->p_ksem != NULL)
+		adderrbuf("verhogenKsem(): wrong process woken   ");
+	if (outKsem(procp[2]) != procp[2] || outKsem(procp[2]) != NULL || ks.ks_value != -1)
+		adderrbuf("outKsem(): failed   ");
+	if (verhogenKsem(&ks) != procp[3] || verhogenKsem(&ks) != NULL || ks.ks_value != 1)
+		adderrbuf("verhogenKsem(): wrong value or queue   ");
+
+	initKsem(&ks, 0);
+	for (i = 1; i < 4; i++)
+		passerenKsem(&ks, procp[i]);
+	tp = mkEmptyProcQ();
+	insertProcQ(&tp, procp[0]);
+	if (broadcastKsem(&ks, &tp) != 3)
+		adderrbuf("broadcastKsem(): wrong number of processes woken   ");
+	if (ks.ks_value != 0 || !emptyProcQ(ks.ks_procQ) || procp[2]->p_ksem != NULL)
+		adderrbuf("broadcastKsem(): semaphore still has waiters   ");
+	if (broadcastKsem(&ks, &tp) != 0 || ks.ks_value != 0)
+		adderrbuf("broadcastKsem(): woke processes from an empty queue   ");
+
+	/* the woken processes belong to tp, not to the semaphore any more */
+	if (removeProcQ(&tp) != procp[0] || !passerenKsem(&ks, procp[0]))
+		adderrbuf("broadcastKsem(): wrong order   ");
+	if (outProcQ(&tp, procp[3]) != procp[3] || ks.ks_value != -1
+	    || headProcQ(ks.ks_procQ) != procp[0])
+		adderrbuf("broadcastKsem(): woken process still on the semaphore   ");
+	for (i = 1; i < 3; i++)
+		if (removeProcQ(&tp) != procp[i])
+			adderrbuf("broadcastKsem(): wrong order   ");
+	if (!emptyProcQ(tp) || verhogenKsem(&ks) != procp[0] || ks.ks_value != 0)
+		adderrbuf("broadcastKsem(): semaphore queue corrupted   ");
+	getStats(&after);
+	if (after.st_aslLookups != before.st_aslLookups)
+		adderrbuf("passerenKsem(): semaphore looked up in the ASL   ");
+
+	/* terminating a waiter gives its unit back */
+	insertChild(procp[0], procp[1]);
+	passerenKsem(&ks, procp[1]);
+	if (terminateSubtree(procp[0]) != 2 || ks.ks_value != 0 || !emptyProcQ(ks.ks_procQ))
+		adderrbuf("terminateSubtree(): waiter left on a ksem_t   ");
+	freePcb(procp[2]);
+	freePcb(procp[3]);
+	addokbuf("ksem_t ok   \n");
+}
+
+
+/* Check the operation counters */
+void testStats(void) {
+	kstats_t st;
+
+	resetStats();
+	procp[0] = allocPcb();
+	procp[1] = allocPcb();
+	if (insertBlocked(&devsem[0], procp[0]) || insertBlocked(&devsem[0], procp[1]))
+		adderrbuf("insertBlocked(): unexpected TRUE   ");
+	if (headBlocked(&devsem[1]) != NULL || outBlocked(procp[1]) != procp[1])
+		adderrbuf("outBlocked(): failed   ");
+	if (removeBlocked(&devsem[0]) != procp[0])
+		adderrbuf("removeBlocked(): failed   ");
+	freePcb(procp[0]);
+
+	getStats(&st);
+	if (st.st_pcbInUse != 1 || st.st_semdInUse != 0)
+		adderrbuf("getStats(): wrong occupancy   ");
+#ifdef KAYA_STATS
+	if (st.st_pcbAllocs != 2 || st.st_pcbFrees != 1 || st.st_pcbPeak != 2)
+		adderrbuf("getStats(): wrong ProcBlk counts   ");
+	if (st.st_aslInserts != 2 || st.st_aslOuts != 1 || st.st_aslRemoves != 1
+	    || st.st_aslHeads != 1 || st.st_aslMisses != 2 || st.st_aslLookups != 4)
+		adderrbuf("getStats(): wrong ASL counts   ");
+	if (st.st_semdPeak != 1 || st.st_semQueuePeak != 2 || st.st_aslVisits < 2)
+		adderrbuf("getStats(): wrong ASL high-water marks   ");
+	if (st.st_qInserts != 2 || st.st_qOuts != 1 || st.st_qRemoves != 1
+	    || st.st_qOutFails != 0 || st.st_qConcats != 0)
+		adderrbuf("getStats(): wrong queue counts   ");
+	if (st.st_pcbAllocFails != 0 || st.st_aslInsertFails != 0 || st.st_aslOutFails != 0
+	    || st.st_aslRemoveAlls != 0 || st.st_childInserts != 0 || st.st_semFast != 0)
+		adderrbuf("getStats(): counted operations that did not happen   ");
+#endif
+	freePcb(procp[1]);
+	addokbuf("getStats() ok   \n");
+}
+
+
+int main() {
+	initPcbs();
+	initASL();
+
+	testRange();
+	testOutBlocked();
+	testBroadcast();
+	testTree();
+	testMlfq();
+	testRunQ();
+	testPrio();
+	testWheel();
+	testTerminate();
+	testDirect();
+	testPV();
+	testKsem();
+	testPid();
+	testCpuTime();
+	testStats();
+	testGrow();
+
+	addokbuf("phase 1 extensions ok   \n");
+	return 0;
+}
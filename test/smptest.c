@@ -0,0 +1,272 @@
+/*********************************SMPTEST.C******************************
+ *
+ *	Test program for the multicore (KAYA_SMP) build of the phase 1
+ *	modules, run on the host with one thread per simulated core.
+ *
+ *	Like p1test, produces progress messages on terminal 0 and
+ *		aborts as soon as an error is detected.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "const.h"
+#include "types.h"
+
+#include "libuarm.h"
+#include "pcb.h"
+#include "asl.h"
+#include "runq.h"
+#include "pid.h"
+#include "ksem.h"
+
+#define ROUNDS 20000
+#define WAITERS 4	/* ProcBlks each core blocks in hammerAsl() */
+
+#if MAXCPU * WAITERS > MAXPROC
+#error "smptest needs WAITERS ProcBlks per core"
+#endif
+
+pcb_t *procp[MAXPROC];
+int running[MAXPROC];	/* running[i] is TRUE while a core holds procp[i] */
+int dispatched[MAXCPU];	/* processes each core ran in hammerRunQ() */
+int privsem[MAXCPU][2];	/* semaphores used by a single core */
+int sharedsem;		/* semaphore used by every core */
+int mutex = 1;		/* semaphore hammerPV() uses as a lock */
+int granted[MAXCPU];	/* granted[i] is TRUE once a verhogen() woke core i */
+int inside;		/* updated only while holding mutex or kmutex */
+ksem_t kmutex;		/* ksem_t hammerKsem() uses as a lock */
+
+/* This function causes the specified character string to be
+ *	written out to terminal0 */
+void addokbuf(char *strp) {
+	tprint(strp);
+}
+
+
+/* This function causes the specified character string to be written
+ *	out to terminal0, then shuts the system down with a panic message */
+void adderrbuf(char *strp) {
+	tprint(strp);
+	PANIC();
+}
+
+
+/* Each core repeatedly allocates a few ProcBlks, tags them with its
+ *	number, checks that nobody else got them, and frees them. Together
+ *	the cores ask for more than MAXPROC, so ProcBlks keep moving
+ *	between the per-core caches and the shared stack */
+void *hammerPcbs(void *arg) {
+	int cpu = (int) (long) arg;
+	int i, j, n;
+	pcb_t *mine[PCBCACHE - 1];
+
+	for (i = 0; i < ROUNDS; i++) {
+		n = 1 + (i + cpu) % (PCBCACHE - 1);
+		for (j = 0; j < n; j++) {
+			if ((mine[j] = allocPcbSMP(cpu)) == NULL)
+				break;
+			mine[j]->p_s = (state_t) (long) (cpu + 1);
+		}
+		n = j;
+		for (j = 0; j < n; j++)
+			if (mine[j]->p_s != (state_t) (long) (cpu + 1))
+				adderrbuf("allocPcbSMP(): ProcBlk handed to two cores   ");
+		for (j = 0; j < n; j++)
+			if (pidPcb(pcbPid(mine[j])) != mine[j])
+				adderrbuf("assignPid(): identifier lost between cores   ");
+		for (j = 0; j < n; j++)
+			freePcbSMP(cpu, mine[j]);
+	}
+	return NULL;
+}
+
+
+/* Each core blocks its ProcBlks on its own semaphores and on one
+ *	shared with the other cores, then wakes them and checks that it
+ *	got its own back, in order */
+void *hammerAsl(void *arg) {
+	int cpu = (int) (long) arg;
+	int i, *sem;
+	pcb_t **mine = &procp[cpu * WAITERS];
+
+	for (i = 0; i < ROUNDS; i++) {
+		sem = &privsem[cpu][i & 1];
+		if (insertBlocked(sem, mine[0]) || insertBlocked(sem, mine[1]) ||
+			insertBlocked(&sharedsem, mine[2]) || insertBlocked(&sharedsem, mine[3]))
+			adderrbuf("insertBlocked(): out of descriptors   ");
+		if (headBlocked(sem) != mine[0])
+			adderrbuf("headBlocked(): wrong head   ");
+		if (outBlocked(mine[3]) != mine[3])
+			adderrbuf("outBlocked(): failed on a shared semaphore   ");
+		if (removeBlocked(sem) != mine[0] || removeBlocked(sem) != mine[1])
+			adderrbuf("removeBlocked(): wrong ProcBlk   ");
+		if (removeBlocked(sem) != NULL)
+			adderrbuf("removeBlocked(): semaphore still active   ");
+		if (outBlocked(mine[2]) != mine[2])
+			adderrbuf("outBlocked(): failed on a shared semaphore   ");
+		if (outBlocked(mine[2]) != NULL)
+			adderrbuf("outBlocked(): ProcBlk removed twice   ");
+	}
+	return NULL;
+}
+
+
+/* Each core takes mutex with passeren(), updates a counter the
+ *	others also update, and gives mutex back with verhogen(); a core
+ *	that blocks spins until a verhogen() hands it the mutex. Lost
+ *	wake-ups hang the test, lost updates show in the counter */
+void *hammerPV(void *arg) {
+	int cpu = (int) (long) arg;
+	pcb_t *me = procp[cpu], *p;
+	int i;
+
+	me->p_s = (state_t) (long) cpu;
+	for (i = 0; i < ROUNDS; i++) {
+		if (passeren(&mutex, me)) {
+			while (!__atomic_load_n(&granted[cpu], __ATOMIC_ACQUIRE))
+				sched_yield();
+			granted[cpu] = FALSE;
+		}
+		inside++;
+		if ((p = verhogen(&mutex)) != NULL)
+			__atomic_store_n(&granted[(int) (long) p->p_s], TRUE, __ATOMIC_RELEASE);
+	}
+	return NULL;
+}
+
+
+/* hammerPV(), with kmutex */
+void *hammerKsem(void *arg) {
+	int cpu = (int) (long) arg;
+	pcb_t *me = procp[cpu], *p;
+	int i;
+
+	me->p_s = (state_t) (long) cpu;
+	for (i = 0; i < ROUNDS; i++) {
+		if (passerenKsem(&kmutex, me)) {
+			while (!__atomic_load_n(&granted[cpu], __ATOMIC_ACQUIRE))
+				sched_yield();
+			granted[cpu] = FALSE;
+		}
+		inside++;
+		if ((p = verhogenKsem(&kmutex)) != NULL)
+			__atomic_store_n(&granted[(int) (long) p->p_s], TRUE, __ATOMIC_RELEASE);
+	}
+	return NULL;
+}
+
+
+/* Each core runs the processes on its run queue and puts them back
+ *	there, stealing when it runs dry. Every process starts on core 0,
+ *	so the others only get work by stealing; a process must never be
+ *	held by two cores at once */
+void *hammerRunQ(void *arg) {
+	int cpu = (int) (long) arg;
+	int i, idx;
+	pcb_t *p;
+
+	for (i = 0; i < ROUNDS; i++) {
+		if ((p = removeRunQ(cpu)) == NULL)
+			continue;
+		idx = (int) (long) p->p_s;
+		if (__atomic_exchange_n(&running[idx], TRUE, __ATOMIC_ACQ_REL))
+			adderrbuf("removeRunQ(): process handed to two cores   ");
+		if (p->p_cpu != cpu)
+			adderrbuf("removeRunQ(): p_cpu not set   ");
+		dispatched[cpu]++;
+		__atomic_store_n(&running[idx], FALSE, __ATOMIC_RELEASE);
+		insertRunQ(cpu, p);
+	}
+	return NULL;
+}
+
+
+int main() {
+	pthread_t cpus[MAXCPU];
+	pcb_t *q;
+	int i, j;
+
+	initPcbs();
+	for (i = 0; i < MAXCPU; i++)
+		pthread_create(&cpus[i], NULL, hammerPcbs, (void *) (long) i);
+	for (i = 0; i < MAXCPU; i++)
+		pthread_join(cpus[i], NULL);
+	if (pcbFreeCount() != MAXPROC || pcbUsedCount() != 0)
+		adderrbuf("pcbFreeCount(): cached ProcBlks not counted as free   ");
+	for (i = 0; i < MAXCPU; i++)
+		flushPcbCache(i);
+	if (pcbFreeCount() != MAXPROC || pcbUsedCount() != 0)
+		adderrbuf("pcbFreeCount(): stacked ProcBlks not counted as free   ");
+
+	/* every ProcBlk must come back exactly once */
+	for (i = 0; i < MAXPROC; i++) {
+		if ((procp[i] = allocPcbSMP(0)) == NULL)
+			adderrbuf("allocPcbSMP(): ProcBlks lost   ");
+		for (j = 0; j < i; j++)
+			if (procp[j] == procp[i])
+				adderrbuf("allocPcbSMP(): ProcBlk allocated twice   ");
+	}
+	if (allocPcbSMP(0) != NULL)
+		adderrbuf("allocPcbSMP(): allocated more than MAXPROC entries   ");
+	if (pcbFreeCount() != 0 || pcbUsedCount() != MAXPROC)
+		adderrbuf("pcbUsedCount(): wrong count   ");
+	addokbuf("allocPcbSMP() and freePcbSMP() ok   \n");
+
+	initASL();
+	for (i = 0; i < MAXCPU; i++)
+		pthread_create(&cpus[i], NULL, hammerAsl, (void *) (long) i);
+	for (i = 0; i < MAXCPU; i++)
+		pthread_join(cpus[i], NULL);
+	if (semdUsedCount() != 0 || semdFreeCount() != MAXPROC)
+		adderrbuf("ASL: descriptors lost   ");
+	addokbuf("concurrent ASL ok   \n");
+
+	for (i = 0; i < MAXCPU; i++)
+		pthread_create(&cpus[i], NULL, hammerPV, (void *) (long) i);
+	for (i = 0; i < MAXCPU; i++)
+		pthread_join(cpus[i], NULL);
+	if (inside != MAXCPU * ROUNDS || mutex != 1 || semdUsedCount() != 0)
+		adderrbuf("passeren() and verhogen(): mutual exclusion broken   ");
+	addokbuf("concurrent passeren() and verhogen() ok   \n");
+
+	initKsem(&kmutex, 1);
+	inside = 0;
+	for (i = 0; i < MAXCPU; i++)
+		pthread_create(&cpus[i], NULL, hammerKsem, (void *) (long) i);
+	for (i = 0; i < MAXCPU; i++)
+		pthread_join(cpus[i], NULL);
+	if (inside != MAXCPU * ROUNDS || kmutex.ks_value != 1 || !emptyProcQ(kmutex.ks_procQ))
+		adderrbuf("passerenKsem() and verhogenKsem(): mutual exclusion broken   ");
+	addokbuf("concurrent ksem_t ok   \n");
+
+	initRunQs();
+	for (i = 0; i < MAXPROC; i++) {
+		procp[i]->p_s = (state_t) (long) i;
+		insertRunQ(0, procp[i]);
+	}
+	for (i = 0; i < MAXCPU; i++)
+		pthread_create(&cpus[i], NULL, hammerRunQ, (void *) (long) i);
+	for (i = 0; i < MAXCPU; i++)
+		pthread_join(cpus[i], NULL);
+	for (i = 0, j = 0; i < MAXCPU; i++) {
+		j += runQCount(i);
+		if (dispatched[i] == 0)
+			adderrbuf("stealRunQ(): a core never got work   ");
+	}
+	if (j != MAXPROC)
+		adderrbuf("run queues: processes lost   ");
+	for (i = 0; i < MAXCPU; i++)
+		while ((q = removeRunQ(i)) != NULL) {
+			if (running[(int) (long) q->p_s])
+				adderrbuf("run queues: process queued twice   ");
+			running[(int) (long) q->p_s] = TRUE;
+		}
+	insertRunQ(1, procp[0]);
+	if (outRunQ(0, procp[0]) != NULL || runQCount(0) != 0 || runQCount(1) != 1)
+		adderrbuf("outRunQ(): removed a process from another core's queue   ");
+	if (outRunQ(1, procp[0]) != procp[0] || runQCount(1) != 0)
+		adderrbuf("outRunQ(): failed on the right core   ");
+	addokbuf("run queues and work stealing ok   \n");
+	return 0;
+}
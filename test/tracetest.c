@@ -0,0 +1,179 @@
+/*********************************TRACETEST.C******************************
+ *
+ *	Test program for the event trace (KAYA_TRACE build) of the
+ *	phase 1 modules, run on the host.
+ *
+ *	Checks the events recorded by the hot paths and the wrap-around
+ *	of the ring, then writes a dumpTrace() image of a short run to
+ *	the file named on the command line, for tools/trace2json.c.
+ *
+ *	Like p1test, produces progress messages on terminal 0 and
+ *		aborts as soon as an error is detected.
+ */
+
+#include <stdio.h>
+
+#include "const.h"
+#include "types.h"
+
+#include "libuarm.h"
+#include "pcb.h"
+#include "asl.h"
+#include "trace.h"
+
+#ifndef KAYA_TRACE
+#error "tracetest needs a KAYA_TRACE build"
+#endif
+
+int sem[4];
+pcb_t *procp[4], *q, *tp;
+trevent_t ev[TRACESIZE];
+double image[(sizeof(trheader_t) + TRACESIZE * sizeof(trevent_t)) / sizeof(double)];
+
+/* This function causes the specified character string to be
+ *	written out to terminal0 */
+void addokbuf(char *strp) {
+	tprint(strp);
+}
+
+
+/* This function causes the specified character string to be written
+ *	out to terminal0, then shuts the system down with a panic message */
+void adderrbuf(char *strp) {
+	tprint(strp);
+	PANIC();
+}
+
+
+/* Check that ev[i] is an event of type type about p */
+void expect(int i, int type, pcb_t *p, unsigned int arg) {
+	if (ev[i].te_type != type || ev[i].te_pcb != tracePcb(p) || ev[i].te_arg != arg)
+		adderrbuf("traceEvent(): wrong event recorded   ");
+	if (i > 0 && (int) (ev[i].te_time - ev[i - 1].te_time) < 0)
+		adderrbuf("traceEvent(): time went backwards   ");
+}
+
+
+/* Check the events of each traced operation */
+void testEvents(void) {
+	int i;
+
+	resetTrace();
+	procp[0] = allocPcb();
+	procp[1] = allocPcb();
+	insertChild(procp[0], procp[1]);
+	tp = mkEmptyProcQ();
+	insertProcQ(&tp, procp[1]);
+	removeProcQ(&tp);
+	insertBlocked(&sem[0], procp[1]);
+	removeBlocked(&sem[0]);
+	insertBlocked(&sem[1], procp[1]);
+	removeAllBlocked(&sem[1], &tp);
+	removeProcQ(&tp);
+	outChild(procp[1]);
+	freePcb(procp[1]);
+
+	if (tracePcb(procp[0]) != 0 || tracePcb(procp[1]) != 1 || tracePcb(NULL) != 0xFFFFFFFF)
+		adderrbuf("tracePcb(): not the pool index   ");
+	if (readTrace(ev, TRACESIZE) != 16)
+		adderrbuf("readTrace(): wrong number of events   ");
+	i = 0;
+	expect(i++, TR_ALLOC, procp[0], 0);
+	expect(i++, TR_ALLOC, procp[1], 0);
+	expect(i++, TR_CHILD, procp[1], tracePcb(procp[0]));
+	expect(i++, TR_QINSERT, procp[1], (unsigned int) (unsigned long) &tp);
+	expect(i++, TR_QREMOVE, procp[1], (unsigned int) (unsigned long) &tp);
+	expect(i++, TR_BLOCK, procp[1], (unsigned int) (unsigned long) &sem[0]);
+	i++;	/* queued on the semaphore */
+	i++;	/* dequeued from it */
+	expect(i++, TR_UNBLOCK, procp[1], (unsigned int) (unsigned long) &sem[0]);
+	expect(i++, TR_BLOCK, procp[1], (unsigned int) (unsigned long) &sem[1]);
+	i++;
+	expect(i++, TR_UNBLOCKALL, NULL, (unsigned int) (unsigned long) &sem[1]);
+	expect(i++, TR_QCONCAT, procp[1], (unsigned int) (unsigned long) &tp);
+	expect(i++, TR_QREMOVE, procp[1], (unsigned int) (unsigned long) &tp);
+	expect(i++, TR_ORPHAN, procp[1], tracePcb(procp[0]));
+	expect(i++, TR_FREE, procp[1], 0);
+	if (readTrace(ev, 2) != 2)
+		adderrbuf("readTrace(): ignored max   ");
+	expect(0, TR_ORPHAN, procp[1], tracePcb(procp[0]));
+	freePcb(procp[0]);
+	addokbuf("traceEvent() and readTrace() ok   \n");
+}
+
+
+/* Fill the ring past its size: the oldest events go, the newest stay */
+void testWrap(void) {
+	trheader_t *th = (trheader_t *) image;
+	int i;
+
+	resetTrace();
+	procp[0] = allocPcb();
+	for (i = 0; i < TRACESIZE; i++) {
+		insertProcQ(&tp, procp[0]);
+		removeProcQ(&tp);
+	}
+	if (readTrace(ev, TRACESIZE) != TRACESIZE)
+		adderrbuf("readTrace(): ring not full   ");
+	expect(0, TR_QINSERT, procp[0], (unsigned int) (unsigned long) &tp);
+	expect(TRACESIZE - 1, TR_QREMOVE, procp[0], (unsigned int) (unsigned long) &tp);
+	if (dumpTrace(image, sizeof(trheader_t) - 1) != 0)
+		adderrbuf("dumpTrace(): wrote past the buffer   ");
+	if (dumpTrace(image, sizeof(trheader_t) + 3 * sizeof(trevent_t)) !=
+		sizeof(trheader_t) + 3 * sizeof(trevent_t))
+		adderrbuf("dumpTrace(): wrong image size   ");
+	if (th->th_count != 3 || th->th_lost != 2 * TRACESIZE - 2 || th->th_size != TRACESIZE)
+		adderrbuf("dumpTrace(): wrong header   ");
+	freePcb(procp[0]);
+	addokbuf("trace ring wrap-around ok   \n");
+}
+
+
+/* A short run of blocking and waking, for trace2json */
+unsigned int sampleRun(void) {
+	int i, j;
+
+	resetTrace();
+	tp = mkEmptyProcQ();
+	for (i = 0; i < 4; i++) {
+		procp[i] = allocPcb();
+		if (i > 0)
+			insertChild(procp[0], procp[i]);
+	}
+	for (j = 0; j < 3; j++) {
+		for (i = 1; i < 4; i++)
+			insertBlocked(&sem[i & 1], procp[i]);
+		while ((q = removeBlocked(&sem[1])) != NULL)
+			insertProcQ(&tp, q);
+		removeAllBlocked(&sem[0], &tp);
+		while (removeProcQ(&tp) != NULL)
+			;
+	}
+	for (i = 3; i >= 0; i--) {
+		if (i > 0)
+			outChild(procp[i]);
+		freePcb(procp[i]);
+	}
+	return dumpTrace(image, sizeof(image));
+}
+
+
+int main(int argc, char *argv[]) {
+	unsigned int len;
+	FILE *f;
+
+	initPcbs();
+	initASL();
+
+	testEvents();
+	testWrap();
+	len = sampleRun();
+	if (argc > 1) {
+		if ((f = fopen(argv[1], "wb")) == NULL || fwrite(image, 1, len, f) != len)
+			adderrbuf("tracetest: cannot write the image   ");
+		fclose(f);
+	}
+
+	addokbuf("event trace ok   \n");
+	return 0;
+}
@@ -0,0 +1,245 @@
+/*********************************TRACE2JSON.C******************************
+ *
+ *	Converts a dumpTrace() image into the Chrome trace event JSON
+ *	read by chrome://tracing and ui.perfetto.dev.
+ *
+ *	Every ProcBlk gets a track (tid) in two processes: "semaphores",
+ *	with a slice for each stretch of time it sat blocked, named after
+ *	the semaphore, and "queues", with a slice for each stretch it
+ *	sat on a process queue, named after the queue's tail pointer.
+ *	Allocation, release and process tree changes are instant events
+ *	on the semaphore track. Slices still open when the trace ends are
+ *	closed at its last event.
+ *
+ *	Usage: trace2json [-t ticks_per_us] [image] > trace.json
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "const.h"
+#include "types.h"
+#include "trace.h"
+
+#define SEMPID 1	/* the "semaphores" process */
+#define QUEUEPID 2	/* the "queues" process */
+
+/**
+* @brief What the converter knows of a ProcBlk.
+*/
+typedef struct track_t {
+	unsigned int tk_pcb;		/* tracePcb() of the ProcBlk; 0xFFFFFFFF if unused */
+	unsigned int tk_sem;		/* semaphore it is blocked on, 0 if none */
+	unsigned int tk_queue;		/* queue it is on, 0 if none */
+	double tk_semFrom;		/* when it blocked */
+	double tk_queueFrom;		/* when it was queued */
+} track_t;
+
+HIDDEN track_t *tracks;
+HIDDEN unsigned int trackSize;	/* slots in tracks, a power of two */
+HIDDEN unsigned int trackUsed;
+HIDDEN double ticksPerUs = 1;
+HIDDEN int records = 0;
+
+
+/* Return the track of ProcBlk id, adding it if new */
+HIDDEN track_t *findTrack(unsigned int id) {
+	unsigned int i, old;
+	track_t *t;
+
+	if (2 * (trackUsed + 1) > trackSize) {	/* keep the table half empty */
+		t = tracks;
+		old = trackSize;
+		trackSize = old ? 2 * old : 64;
+		tracks = malloc(trackSize * sizeof(track_t));
+		if (tracks == NULL) {
+			perror("trace2json");
+			exit(1);
+		}
+		for (i = 0; i < trackSize; i++)
+			tracks[i].tk_pcb = 0xFFFFFFFF;
+		trackUsed = 0;
+		for (i = 0; i < old; i++)
+			if (t[i].tk_pcb != 0xFFFFFFFF)
+				*findTrack(t[i].tk_pcb) = t[i];
+		free(t);
+	}
+	for (i = (id * 2654435769u) & (trackSize - 1); tracks[i].tk_pcb != id;
+		i = (i + 1) & (trackSize - 1))
+		if (tracks[i].tk_pcb == 0xFFFFFFFF) {
+			memset(&tracks[i], 0, sizeof(track_t));
+			tracks[i].tk_pcb = id;
+			trackUsed++;
+			break;
+		}
+	return &tracks[i];
+}
+
+
+/* Print a JSON event, the fields after the common ones given by fmt */
+HIDDEN void emit(int pid, unsigned int tid, double ts, const char *fmt, ...) {
+	va_list ap;
+
+	printf("%s\n  {\"pid\": %d, \"tid\": %u, \"ts\": %.3f, ", records ? "," : "", pid, tid, ts);
+	va_start(ap, fmt);
+	vprintf(fmt, ap);
+	va_end(ap);
+	printf("}");
+	records++;
+}
+
+
+/* Close the blocked slice of t at time ts, if one is open */
+HIDDEN void endBlocked(track_t *t, double ts) {
+	if (t->tk_sem == 0)
+		return;
+	emit(SEMPID, t->tk_pcb, t->tk_semFrom,
+		"\"ph\": \"X\", \"dur\": %.3f, \"name\": \"blocked on 0x%x\", \"cat\": \"asl\"",
+		ts - t->tk_semFrom, t->tk_sem);
+	t->tk_sem = 0;
+}
+
+
+/* Close the queued slice of t at time ts, if one is open */
+HIDDEN void endQueued(track_t *t, double ts) {
+	if (t->tk_queue == 0)
+		return;
+	emit(QUEUEPID, t->tk_pcb, t->tk_queueFrom,
+		"\"ph\": \"X\", \"dur\": %.3f, \"name\": \"queued on 0x%x\", \"cat\": \"procq\"",
+		ts - t->tk_queueFrom, t->tk_queue);
+	t->tk_queue = 0;
+}
+
+
+HIDDEN void instant(track_t *t, double ts, const char *name, unsigned int other) {
+	if (other == 0xFFFFFFFF)
+		emit(SEMPID, t->tk_pcb, ts, "\"ph\": \"i\", \"s\": \"t\", \"name\": \"%s\"", name);
+	else
+		emit(SEMPID, t->tk_pcb, ts, "\"ph\": \"i\", \"s\": \"t\", \"name\": \"%s %u\"",
+			name, other);
+}
+
+
+/* Replay ev[0..n) */
+HIDDEN void convert(trevent_t *ev, unsigned int n) {
+	unsigned long long ticks = 0;
+	unsigned int i, j, from;
+	double ts = 0;
+	track_t *t;
+
+	for (i = 0; i < n; i++) {
+		if (i > 0)	/* te_time wraps around, differences do not */
+			ticks += ev[i].te_time - ev[i - 1].te_time;
+		ts = ticks / ticksPerUs;
+		if (ev[i].te_type == TR_UNBLOCKALL)	/* names no ProcBlk */
+			t = NULL;
+		else if (ev[i].te_pcb == 0xFFFFFFFF)
+			continue;
+		else
+			t = findTrack(ev[i].te_pcb);
+		switch (ev[i].te_type) {
+		case TR_ALLOC:
+			instant(t, ts, "alloc", 0xFFFFFFFF);
+			break;
+		case TR_FREE:
+			endBlocked(t, ts);
+			endQueued(t, ts);
+			instant(t, ts, "free", 0xFFFFFFFF);
+			break;
+		case TR_QINSERT:
+			endQueued(t, ts);
+			t->tk_queue = ev[i].te_arg;
+			t->tk_queueFrom = ts;
+			break;
+		case TR_QREMOVE:
+			endQueued(t, ts);
+			break;
+		case TR_QCONCAT:	/* everything on the head's queue moves to te_arg */
+			if ((from = t->tk_queue) == 0)
+				break;
+			for (j = 0; j < trackSize; j++)
+				if (tracks[j].tk_pcb != 0xFFFFFFFF && tracks[j].tk_queue == from) {
+					endQueued(&tracks[j], ts);
+					tracks[j].tk_queue = ev[i].te_arg;
+					tracks[j].tk_queueFrom = ts;
+				}
+			break;
+		case TR_BLOCK:
+			endBlocked(t, ts);
+			t->tk_sem = ev[i].te_arg;
+			t->tk_semFrom = ts;
+			break;
+		case TR_UNBLOCK:
+			endBlocked(t, ts);
+			break;
+		case TR_UNBLOCKALL:
+			for (j = 0; j < trackSize; j++)
+				if (tracks[j].tk_pcb != 0xFFFFFFFF && tracks[j].tk_sem == ev[i].te_arg)
+					endBlocked(&tracks[j], ts);
+			break;
+		case TR_CHILD:
+			instant(t, ts, "child of", ev[i].te_arg);
+			break;
+		case TR_ORPHAN:
+			instant(t, ts, "orphaned from", ev[i].te_arg);
+			break;
+		default:
+			fprintf(stderr, "trace2json: unknown event type %u\n", ev[i].te_type);
+		}
+	}
+	for (j = 0; j < trackSize; j++)
+		if (tracks[j].tk_pcb != 0xFFFFFFFF) {
+			endBlocked(&tracks[j], ts);
+			endQueued(&tracks[j], ts);
+		}
+}
+
+
+int main(int argc, char *argv[]) {
+	FILE *in = stdin;
+	trheader_t th;
+	trevent_t *ev;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+			ticksPerUs = atof(argv[++i]);
+		else if (argv[i][0] != '-' && in == stdin) {
+			if ((in = fopen(argv[i], "rb")) == NULL) {
+				perror(argv[i]);
+				return 1;
+			}
+		}
+		else {
+			fprintf(stderr, "usage: %s [-t ticks_per_us] [image]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (ticksPerUs <= 0)
+		ticksPerUs = 1;
+
+	if (fread(&th, sizeof(th), 1, in) != 1 || memcmp(th.th_magic, "KTRC", 4) != 0) {
+		fprintf(stderr, "trace2json: not a trace image\n");
+		return 1;
+	}
+	if ((ev = malloc((th.th_count + 1) * sizeof(trevent_t))) == NULL) {
+		perror("trace2json");
+		return 1;
+	}
+	if (fread(ev, sizeof(trevent_t), th.th_count, in) != th.th_count) {
+		fprintf(stderr, "trace2json: image truncated\n");
+		return 1;
+	}
+	if (th.th_lost > 0)
+		fprintf(stderr, "trace2json: %u older events were overwritten\n", th.th_lost);
+
+	printf("{\"displayTimeUnit\": \"ns\", \"otherData\": {\"events\": %u, \"lost\": %u, "
+		"\"size\": %u}, \"traceEvents\": [", th.th_count, th.th_lost, th.th_size);
+	emit(SEMPID, 0, 0, "\"ph\": \"M\", \"name\": \"process_name\", \"args\": {\"name\": \"semaphores\"}");
+	emit(QUEUEPID, 0, 0, "\"ph\": \"M\", \"name\": \"process_name\", \"args\": {\"name\": \"queues\"}");
+	convert(ev, th.th_count);
+	printf("\n]}\n");
+	return 0;
+}